@@ -0,0 +1,80 @@
+/***********************************************************************
+ * Source File:
+ *    AMMUNITION
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The registry of compiled rounds
+ ************************************************************************/
+
+#include "ammunition.h"
+#include "batchProjectile.h"
+#include <cstring>   // for strcmp
+using namespace std;
+
+/***********************************************************************
+ * ADVANCE AS
+ * A plain function for the registry to point to
+ ************************************************************************/
+template <class Round>
+static void advanceAs(BatchProjectile& rounds, double simulationTime)
+{
+   rounds.advance<Round>(simulationTime);
+}
+
+/***********************************************************************
+ * ADVANCE EACH AS
+ ************************************************************************/
+template <class Round>
+static void advanceEachAs(BatchProjectile& rounds, double simulationTime)
+{
+   rounds.advanceEach<Round>(simulationTime);
+}
+
+/***********************************************************************
+ * SPEC
+ * A registry entry from a round's constants
+ ************************************************************************/
+template <class Round>
+static AmmunitionSpec spec(AmmunitionType type)
+{
+   AmmunitionSpec entry;
+   entry.type = type;
+   entry.name = Round::name();
+   entry.mass = Round::mass;
+   entry.radius = Round::radius;
+   entry.dragScale = Round::dragScale;
+   entry.drag = &Round::drag;
+   entry.dragSlope = &Round::dragSlope;
+   entry.advance = &advanceAs<Round>;
+   entry.advanceEach = &advanceEachAs<Round>;
+   return entry;
+}
+
+// in the same order as AmmunitionType
+static const AmmunitionSpec registry[AMMUNITION_TYPES] =
+{
+   spec<M795>(AMMUNITION_M795)
+};
+
+/***********************************************************************
+ * GET AMMUNITION
+ ************************************************************************/
+const AmmunitionSpec& getAmmunition(AmmunitionType type)
+{
+   return registry[type];
+}
+
+/***********************************************************************
+ * FIND AMMUNITION
+ ************************************************************************/
+bool findAmmunition(const char* name, AmmunitionType& type)
+{
+   for (const AmmunitionSpec& entry : registry)
+      if (strcmp(entry.name, name) == 0)
+      {
+         type = entry.type;
+         return true;
+      }
+   return false;
+}
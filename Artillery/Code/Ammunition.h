@@ -0,0 +1,84 @@
+/**********************************************************************
+ * Header File:
+ *    AMMUNITION
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The rounds a 155mm howitzer can fire. Each one is a type with its
+ *    mass, radius, and drag table as compile-time constants, so code
+ *    written against it is compiled once per round with all of them
+ *    folded in. The registry at the bottom holds one compiled copy of
+ *    each so the round can still be picked while the game is running.
+ *    Only the M795 is here: it is the one round with a published drag
+ *    table. Another round joins with its own type, AmmunitionType, and
+ *    registry entry once its drag is sourced.
+ *
+ *    Drag is 1/2 rho v^2 Cd pi r^2, so the deceleration is
+ *    rho v^2 Cd times dragScale = pi r^2 / (2 m), known in advance.
+ ************************************************************************/
+
+#pragma once
+
+#include <cmath>
+#include "atmosphereTable.h"
+
+class BatchProjectile;
+
+/**********************************************************************
+ * M795
+ * The standard high explosive round, and the default
+ ************************************************************************/
+struct M795
+{
+   static constexpr double mass = 46.7;         // kg
+   static constexpr double radius = 0.077545;   // m
+   static constexpr double dragScale = M_PI * radius * radius / (2.0 * mass);
+
+   static const char* name() { return "M795"; }
+   static double drag(double mach) { return dragTable(mach); }
+   static double dragSlope(double mach) { return dragTable.slope(mach); }
+#ifdef __AVX2__
+   static __m256d drag(__m256d mach) { return dragTable(mach); }
+#endif
+};
+
+/**********************************************************************
+ * AMMUNITION TYPE
+ * Which round, while the game is running
+ ************************************************************************/
+enum AmmunitionType
+{
+   AMMUNITION_M795,
+   AMMUNITION_TYPES     // how many there are
+};
+
+/**********************************************************************
+ * AMMUNITION SPEC
+ * One entry in the registry: the constants of a round, and the
+ * versions of the code compiled for it
+ ************************************************************************/
+struct AmmunitionSpec
+{
+   AmmunitionType type;
+   const char* name;
+   double mass;        // kg
+   double radius;      // m
+   double dragScale;   // m^2/kg
+
+   // drag coefficient from Mach, and how fast it changes with Mach
+   double (*drag)(double mach);
+   double (*dragSlope)(double mach);
+
+   // BatchProjectile::advance<Round>, for a pool of only this round
+   void (*advance)(BatchProjectile& rounds, double simulationTime);
+
+   // BatchProjectile::advanceEach<Round>: every round with its own mass
+   // and radius, but this round's drag
+   void (*advanceEach)(BatchProjectile& rounds, double simulationTime);
+};
+
+// the registry entry for a round
+const AmmunitionSpec& getAmmunition(AmmunitionType type);
+
+// look a round up by name, as in "M795". False if there is no such round.
+bool findAmmunition(const char* name, AmmunitionType& type);
@@ -0,0 +1,49 @@
+/***********************************************************************
+ * Source File:
+ *    ARTILLERY TESTS
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    artillerytests: the numerical checks that are too slow, or need too
+ *    much of the simulator, to run on every start of the game. It is its
+ *    own program, built like salvobench: this file and every source
+ *    file except the other mains (main.cpp, salvoBenchmark.cpp,
+ *    ballisticDaemon.cpp) and the window (simulation.cpp,
+ *    uiInteract.cpp). The exit status is zero only when every check
+ *    passes.
+ ************************************************************************/
+
+#include "testAtmosphereTable.h"
+#include "testBallistics.h"
+#include "testTerrainPyramid.h"
+#include "testBatchProjectile.h"
+#include "position.h"
+using namespace std;
+
+double Position::metersFromPixels = 40.0;
+
+/***********************************************************************
+ * MAIN
+ ************************************************************************/
+int main()
+{
+   int failed = 0;
+
+   TestAtmosphereTable atmosphereTable;
+   atmosphereTable.run();
+   failed += atmosphereTable.report();
+
+   TestBatchProjectile batchProjectile;
+   batchProjectile.run();
+   failed += batchProjectile.report();
+
+   TestBallistics ballistics;
+   ballistics.run();
+   failed += ballistics.report();
+
+   TestTerrainPyramid terrainPyramid;
+   terrainPyramid.run();
+   failed += terrainPyramid.report();
+
+   return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+/**********************************************************************
+ * Header File:
+ *    ATMOSPHERE TABLE
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Drag, air density, and speed of sound without searching a table
+ *    every step. The published tables have uneven spacing, so the
+ *    compiler resamples each one onto an even grid. Every breakpoint of
+ *    the published tables lands on a grid point, so the resampled table
+ *    gives exactly the same straight lines. A lookup is then one
+ *    multiply, one truncate, and one linear interpolation.
+ *
+ *    The points below are typed in a second time from the tables
+ *    physics.h searches. The static_asserts only show that resampling
+ *    kept the lines of these copies; TestAtmosphereTable is what
+ *    compares them against physics.h.
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>   // for size_t
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**********************************************************************
+ * TABLE POINT
+ * One row of a published table
+ ************************************************************************/
+struct TablePoint
+{
+   double x;
+   double y;
+};
+
+// drag coefficient from Mach
+constexpr TablePoint machDrag[] =
+{
+   { 0.300, 0.1629 }, { 0.500, 0.1659 }, { 0.700, 0.2031 }, { 0.890, 0.2597 },
+   { 0.920, 0.3010 }, { 0.960, 0.3287 }, { 0.980, 0.4002 }, { 1.000, 0.4258 },
+   { 1.020, 0.4335 }, { 1.060, 0.4483 }, { 1.240, 0.4064 }, { 1.530, 0.3663 },
+   { 1.990, 0.2897 }, { 2.870, 0.2297 }, { 2.890, 0.2306 }, { 5.000, 0.2656 }
+};
+
+// air density in kg/m^3 from altitude in meters
+constexpr TablePoint altitudeDensity[] =
+{
+   {     0.0, 1.2250000 }, {  1000.0, 1.1120000 }, {  2000.0, 1.0070000 },
+   {  3000.0, 0.9093000 }, {  4000.0, 0.8194000 }, {  5000.0, 0.7364000 },
+   {  6000.0, 0.6601000 }, {  7000.0, 0.5900000 }, {  8000.0, 0.5258000 },
+   {  9000.0, 0.4671000 }, { 10000.0, 0.4135000 }, { 15000.0, 0.1948000 },
+   { 20000.0, 0.0889100 }, { 25000.0, 0.0400800 }, { 30000.0, 0.0184100 },
+   { 40000.0, 0.0039960 }, { 50000.0, 0.0010270 }, { 60000.0, 0.0003097 },
+   { 70000.0, 0.0000828 }, { 80000.0, 0.0000185 }
+};
+
+// speed of sound in m/s from altitude in meters
+constexpr TablePoint altitudeSpeedSound[] =
+{
+   {     0.0, 340.0 }, {  1000.0, 336.0 }, {  2000.0, 332.0 }, {  3000.0, 328.0 },
+   {  4000.0, 324.0 }, {  5000.0, 320.0 }, {  6000.0, 316.0 }, {  7000.0, 312.0 },
+   {  8000.0, 308.0 }, {  9000.0, 303.0 }, { 10000.0, 299.0 }, { 15000.0, 295.0 },
+   { 20000.0, 295.0 }, { 25000.0, 295.0 }, { 30000.0, 305.0 }, { 40000.0, 324.0 },
+   { 50000.0, 337.0 }, { 60000.0, 319.0 }, { 70000.0, 289.0 }, { 80000.0, 269.0 }
+};
+
+/**********************************************************************
+ * INTERPOLATE TABLE
+ * The original way: find the two rows around x and draw a line between
+ * them. Anything off either end gets the end value.
+ ************************************************************************/
+template <size_t N>
+constexpr double interpolateTable(const TablePoint (&table)[N], double x)
+{
+   if (x <= table[0].x)
+      return table[0].y;
+   for (size_t i = 1; i < N; i++)
+      if (x <= table[i].x)
+         return table[i - 1].y + (x - table[i - 1].x) *
+            (table[i].y - table[i - 1].y) / (table[i].x - table[i - 1].x);
+   return table[N - 1].y;
+}
+
+/**********************************************************************
+ * UNIFORM TABLE
+ * A table resampled every step units from start, built by the compiler
+ ************************************************************************/
+template <int N>
+struct UniformTable
+{
+   static_assert(N >= 2, "a table needs at least two points");
+
+   template <size_t M>
+   constexpr UniformTable(const TablePoint (&table)[M], double step) :
+      start(table[0].x),
+      step(step),
+      inverse(1.0 / step),
+      values()
+   {
+      for (int i = 0; i < N; i++)
+         values[i] = interpolateTable(table, start + i * step);
+   }
+
+   // one value
+   double operator()(double x) const
+   {
+      double index = (x - start) * inverse;
+      // written so NaN lands on the first value, as _mm256_max_pd does
+      index = !(index >= 0.0) ? 0.0 : (index > N - 1 ? N - 1 : index);
+      int i = (int)index;
+      i = i > N - 2 ? N - 2 : i;
+      double fraction = index - i;
+      return values[i] + fraction * (values[i + 1] - values[i]);
+   }
+
+   // the slope of the line at x, zero off either end where the value
+   // stops changing
+   double slope(double x) const
+   {
+      double index = (x - start) * inverse;
+      if (!(index >= 0.0 && index <= N - 1))
+         return 0.0;
+      int i = (int)index;
+      i = i > N - 2 ? N - 2 : i;
+      return (values[i + 1] - values[i]) * inverse;
+   }
+
+#ifdef __AVX2__
+   // four values at once
+   __m256d operator()(__m256d x) const
+   {
+      __m256d index = _mm256_mul_pd(_mm256_sub_pd(x, _mm256_set1_pd(start)),
+                                    _mm256_set1_pd(inverse));
+      index = _mm256_min_pd(_mm256_max_pd(index, _mm256_setzero_pd()), _mm256_set1_pd(N - 1));
+      __m128i segment = _mm_min_epi32(_mm256_cvttpd_epi32(index), _mm_set1_epi32(N - 2));
+      __m256d fraction = _mm256_sub_pd(index, _mm256_cvtepi32_pd(segment));
+      __m256d low = _mm256_i32gather_pd(values, segment, 8);
+      __m256d high = _mm256_i32gather_pd(values + 1, segment, 8);
+      return _mm256_add_pd(low, _mm256_mul_pd(fraction, _mm256_sub_pd(high, low)));
+   }
+#endif
+
+   // many values at once
+   void operator()(const double* x, double* y, size_t count) const
+   {
+      size_t i = 0;
+#ifdef __AVX2__
+      for (; i + 4 <= count; i += 4)
+         _mm256_storeu_pd(y + i, (*this)(_mm256_loadu_pd(x + i)));
+#endif
+      for (; i < count; i++)
+         y[i] = (*this)(x[i]);
+   }
+
+   // does the resampled table draw the same lines as the points it was
+   // built from? This checks the resampling, not the points.
+   template <size_t M>
+   constexpr bool matches(const TablePoint (&table)[M], double tolerance) const
+   {
+      for (size_t j = 0; j + 1 < M; j++)
+         for (int k = 0; k <= 4; k++)
+         {
+            double x = table[j].x + (table[j + 1].x - table[j].x) * k / 4.0;
+            double index = (x - start) * inverse;
+            int i = (int)index;
+            i = i > N - 2 ? N - 2 : i;
+            double fast = values[i] + (index - i) * (values[i + 1] - values[i]);
+            double error = fast - interpolateTable(table, x);
+            if (error > tolerance || -error > tolerance)
+               return false;
+         }
+      return true;
+   }
+
+   double start;      // x of the first value
+   double step;       // x between values
+   double inverse;    // 1 / step
+   double values[N];
+};
+
+// Mach 0.30 to 5.00 every 0.01, altitude 0 to 80 km every kilometer
+constexpr UniformTable<471> dragTable(machDrag, 0.01);
+constexpr UniformTable<81>  densityTable(altitudeDensity, 1000.0);
+constexpr UniformTable<81>  speedSoundTable(altitudeSpeedSound, 1000.0);
+
+// the grid kept every line of the points above
+static_assert(dragTable.matches(machDrag, 1e-9), "drag table does not match");
+static_assert(densityTable.matches(altitudeDensity, 1e-9), "density table does not match");
+static_assert(speedSoundTable.matches(altitudeSpeedSound, 1e-9), "speed of sound table does not match");
+
+/**********************************************************************
+ * LOOKUPS
+ * Meant to give the same answers as the searching versions in
+ * physics.h; TestAtmosphereTable says whether they do
+ ************************************************************************/
+inline double dragFromMachFast(double mach)                { return dragTable(mach); }
+inline double densityFromAltitudeFast(double altitude)     { return densityTable(altitude); }
+inline double speedSoundFromAltitudeFast(double altitude)  { return speedSoundTable(altitude); }
@@ -0,0 +1,116 @@
+/***********************************************************************
+ * Source File:
+ *    BALLISTIC CLIENT
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Sending batches to the ballistic daemon
+ ************************************************************************/
+
+#include "ballisticClient.h"
+#include <algorithm>   // for min
+#include <cstring>     // for strncpy
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+
+#define CLIENT_MAX_BATCH 65535   // queries that fit in one batch header
+
+/***********************************************************************
+ * SEND ALL
+ ************************************************************************/
+static bool sendAll(int fd, const void* data, size_t size)
+{
+   const char* bytes = (const char*)data;
+   while (size > 0)
+   {
+      ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+      if (sent <= 0)
+         return false;
+      bytes += sent;
+      size -= sent;
+   }
+   return true;
+}
+
+/***********************************************************************
+ * RECEIVE ALL
+ ************************************************************************/
+static bool receiveAll(int fd, void* data, size_t size)
+{
+   char* bytes = (char*)data;
+   while (size > 0)
+   {
+      ssize_t received = ::recv(fd, bytes, size, 0);
+      if (received <= 0)
+         return false;
+      bytes += received;
+      size -= received;
+   }
+   return true;
+}
+
+/***********************************************************************
+ * BALLISTIC CLIENT :: OPEN
+ ************************************************************************/
+bool BallisticClient::open(const char* path)
+{
+   close();
+   fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0)
+      return false;
+
+   sockaddr_un address = {};
+   address.sun_family = AF_UNIX;
+   strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+   if (::connect(fd, (const sockaddr*)&address, sizeof(address)) != 0)
+   {
+      close();
+      return false;
+   }
+   return true;
+}
+
+/***********************************************************************
+ * BALLISTIC CLIENT :: CLOSE
+ ************************************************************************/
+void BallisticClient::close()
+{
+   if (fd >= 0)
+      ::close(fd);
+   fd = -1;
+}
+
+/***********************************************************************
+ * BALLISTIC CLIENT :: QUERY
+ * More queries than one header can count go as several batches, each
+ * answered before the next is sent. The daemon only holds one batch of
+ * answers for a client, so sending them all first would leave both
+ * ends waiting on the other.
+ ************************************************************************/
+bool BallisticClient::query(const vector <BallisticQuery>& queries,
+                            vector <BallisticAnswer>& answers)
+{
+   answers.resize(queries.size());
+   if (fd < 0)
+      return false;
+
+   for (size_t first = 0; first < queries.size(); first += CLIENT_MAX_BATCH)
+   {
+      BallisticBatchHeader header;
+      header.magic = BALLISTIC_MAGIC;
+      header.version = BALLISTIC_VERSION;
+      header.count = (uint16_t)min((size_t)CLIENT_MAX_BATCH, queries.size() - first);
+      if (!sendAll(fd, &header, sizeof(header)) ||
+          !sendAll(fd, &queries[first], header.count * sizeof(BallisticQuery)))
+         return false;
+
+      uint16_t count = header.count;
+      if (!receiveAll(fd, &header, sizeof(header)) || header.magic != BALLISTIC_MAGIC ||
+          header.count != count ||
+          !receiveAll(fd, &answers[first], header.count * sizeof(BallisticAnswer)))
+         return false;
+   }
+   return true;
+}
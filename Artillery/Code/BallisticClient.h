@@ -0,0 +1,41 @@
+/**********************************************************************
+ * Header File:
+ *    BALLISTIC CLIENT
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The tool's end of the socket to the ballistic daemon, so a tool
+ *    that only needs answers does not link the simulator. POSIX only.
+ ************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "ballisticProtocol.h"
+
+/**********************************************************************
+ * BALLISTIC CLIENT
+ * One connection to the daemon
+ ************************************************************************/
+class BallisticClient
+{
+public:
+   BallisticClient() : fd(-1) {}
+   ~BallisticClient() { close(); }
+
+   // connect to the daemon. False if it is not running.
+   bool open(const char* path = BALLISTIC_SOCKET);
+   void close();
+   bool isOpen() const { return fd >= 0; }
+
+   // send the queries and wait for their answers, in the same order.
+   // False if the daemon went away.
+   bool query(const std::vector <BallisticQuery>& queries,
+              std::vector <BallisticAnswer>& answers);
+
+private:
+   BallisticClient(const BallisticClient&);              // one owner of the socket
+   BallisticClient& operator = (const BallisticClient&);
+
+   int fd;   // the socket
+};
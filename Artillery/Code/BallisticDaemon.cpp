@@ -0,0 +1,309 @@
+/***********************************************************************
+ * Source File:
+ *    BALLISTIC DAEMON
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    ballisticd: a long-running server of trajectory answers on a Unix
+ *    domain socket, so tools pay for starting the simulator once. It is
+ *    its own program, built without main.cpp, and POSIX only.
+ *
+ *    One thread waits on every connection at once. Each time it wakes,
+ *    every complete batch from every client is put into one, which the
+ *    service answers from its cache or flies across all the cores, and
+ *    the answers are split back to whoever asked. The more clients ask
+ *    at once, the bigger the batches and the more the work is shared.
+ *    A client holds at most one batch of queries and one of answers
+ *    here; past that it is not read until it reads what it is owed.
+ *    SIGINT or SIGTERM ends it and removes the socket.
+ *
+ *    usage: ballisticd [socket path]
+ ************************************************************************/
+
+#include "ballisticService.h"
+#include "ballisticProtocol.h"
+#include "position.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>   // for memcpy and strncpy
+#include <algorithm> // for min
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+
+#define DAEMON_READ_SIZE 65536   // bytes read from a client at a time
+#define DAEMON_MAX_IN  (sizeof(BallisticBatchHeader) + 65535 * sizeof(BallisticQuery))
+#define DAEMON_MAX_OUT (sizeof(BallisticBatchHeader) + 65535 * sizeof(BallisticAnswer))
+
+double Position::metersFromPixels = 40.0;
+
+static volatile sig_atomic_t stopping = 0;   // set by SIGINT or SIGTERM
+
+/***********************************************************************
+ * CLIENT
+ * One connection and what is waiting to be read or written
+ ************************************************************************/
+struct Client
+{
+   int fd;
+   vector <char> in;    // bytes received, not yet a whole batch
+   vector <char> out;   // answers not yet sent
+   bool closed;
+};
+
+/***********************************************************************
+ * OWNER
+ * Whose queries are where in the combined batch
+ ************************************************************************/
+struct Owner
+{
+   size_t client;
+   size_t first;
+   size_t count;
+};
+
+/***********************************************************************
+ * STOP
+ ************************************************************************/
+static void stop(int)
+{
+   stopping = 1;
+}
+
+/***********************************************************************
+ * IS LISTENING
+ * Whether to read from a client: not while it owes us a whole batch of
+ * answers, and not more than a whole batch of queries
+ ************************************************************************/
+static bool isListening(const Client& client)
+{
+   return client.out.size() < DAEMON_MAX_OUT && client.in.size() < DAEMON_MAX_IN;
+}
+
+/***********************************************************************
+ * SET NONBLOCKING
+ ************************************************************************/
+static bool setNonblocking(int fd)
+{
+   int flags = fcntl(fd, F_GETFL, 0);
+   return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/***********************************************************************
+ * LISTEN ON
+ ************************************************************************/
+static int listenOn(const char* path)
+{
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0)
+      return -1;
+
+   sockaddr_un address = {};
+   address.sun_family = AF_UNIX;
+   strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+   unlink(path);
+   if (bind(fd, (const sockaddr*)&address, sizeof(address)) != 0 ||
+       listen(fd, SOMAXCONN) != 0 || !setNonblocking(fd))
+   {
+      close(fd);
+      return -1;
+   }
+   return fd;
+}
+
+/***********************************************************************
+ * RECEIVE
+ * What the client has sent so far, up to a whole batch
+ ************************************************************************/
+static void receive(Client& client)
+{
+   char buffer[DAEMON_READ_SIZE];
+   while (client.in.size() < DAEMON_MAX_IN)
+   {
+      size_t room = min(sizeof(buffer), DAEMON_MAX_IN - client.in.size());
+      ssize_t received = recv(client.fd, buffer, room, 0);
+      if (received > 0)
+         client.in.insert(client.in.end(), buffer, buffer + received);
+      else
+      {
+         if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            client.closed = true;
+         if (received == 0 || errno != EINTR)
+            return;
+      }
+   }
+}
+
+/***********************************************************************
+ * TRANSMIT
+ * As much of the answers as the socket will take
+ ************************************************************************/
+static void transmit(Client& client)
+{
+   size_t sent = 0;
+   while (sent < client.out.size())
+   {
+      ssize_t count = send(client.fd, client.out.data() + sent, client.out.size() - sent,
+                           MSG_NOSIGNAL);
+      if (count > 0)
+         sent += count;
+      else
+      {
+         if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            client.closed = true;
+         if (count == 0 || errno != EINTR)
+            break;
+      }
+   }
+   client.out.erase(client.out.begin(), client.out.begin() + sent);
+}
+
+/***********************************************************************
+ * GATHER
+ * Every whole batch a client has sent, onto the end of the combined
+ * batch. A client that sends something that is not a batch is dropped.
+ ************************************************************************/
+static void gather(Client& client, size_t index, vector <BallisticQuery>& batch,
+                   vector <Owner>& owners)
+{
+   size_t used = 0;
+   while (client.in.size() - used >= sizeof(BallisticBatchHeader))
+   {
+      BallisticBatchHeader header;
+      memcpy(&header, client.in.data() + used, sizeof(header));
+      if (header.magic != BALLISTIC_MAGIC || header.version != BALLISTIC_VERSION)
+      {
+         client.closed = true;
+         return;
+      }
+
+      size_t size = sizeof(header) + header.count * sizeof(BallisticQuery);
+      if (client.in.size() - used < size)
+         break;
+
+      Owner owner = { index, batch.size(), header.count };
+      batch.resize(batch.size() + header.count);
+      memcpy(batch.data() + owner.first, client.in.data() + used + sizeof(header),
+             header.count * sizeof(BallisticQuery));
+      owners.push_back(owner);
+      used += size;
+   }
+   client.in.erase(client.in.begin(), client.in.begin() + used);
+}
+
+/***********************************************************************
+ * MAIN
+ ************************************************************************/
+int main(int argc, char** argv)
+{
+   const char* path = argc > 1 ? argv[1] : BALLISTIC_SOCKET;
+   signal(SIGPIPE, SIG_IGN);
+
+   // no SA_RESTART, so poll wakes up to see it
+   struct sigaction action = {};
+   action.sa_handler = stop;
+   sigemptyset(&action.sa_mask);
+   sigaction(SIGINT, &action, nullptr);
+   sigaction(SIGTERM, &action, nullptr);
+
+   int listener = listenOn(path);
+   if (listener < 0)
+   {
+      perror(path);
+      return 1;
+   }
+   printf("ballisticd listening on %s\n", path);
+
+   BallisticService service;
+   vector <Client> clients;
+   vector <pollfd> waiting;
+   vector <BallisticQuery> batch;
+   vector <BallisticAnswer> answers;
+   vector <Owner> owners;
+
+   while (!stopping)
+   {
+      waiting.clear();
+      pollfd listening = { listener, POLLIN, 0 };
+      waiting.push_back(listening);
+      for (const Client& client : clients)
+      {
+         pollfd entry = { client.fd, (short)((isListening(client) ? POLLIN : 0) |
+                                             (client.out.empty() ? 0 : POLLOUT)), 0 };
+         waiting.push_back(entry);
+      }
+      if (poll(waiting.data(), waiting.size(), -1) < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         break;
+      }
+
+      // new connections
+      if (waiting[0].revents & POLLIN)
+         for (int fd = accept(listener, nullptr, nullptr); fd >= 0;
+              fd = accept(listener, nullptr, nullptr))
+         {
+            if (!setNonblocking(fd))
+            {
+               close(fd);
+               continue;
+            }
+            Client client;
+            client.fd = fd;
+            client.closed = false;
+            clients.push_back(client);
+         }
+
+      // read everyone, then answer everyone in one batch
+      batch.clear();
+      owners.clear();
+      for (size_t i = 0; i + 1 < waiting.size(); i++)
+         if ((waiting[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) &&
+             clients[i].out.size() < DAEMON_MAX_OUT)
+            receive(clients[i]);
+      for (size_t i = 0; i < clients.size(); i++)
+         if (!clients[i].closed && clients[i].out.size() < DAEMON_MAX_OUT)
+            gather(clients[i], i, batch, owners);
+
+      if (!batch.empty())
+      {
+         answers.resize(batch.size());
+         service.answer(batch.data(), batch.size(), answers.data());
+         for (const Owner& owner : owners)
+         {
+            BallisticBatchHeader header;
+            header.magic = BALLISTIC_MAGIC;
+            header.version = BALLISTIC_VERSION;
+            header.count = (uint16_t)owner.count;
+            vector <char>& out = clients[owner.client].out;
+            const char* bytes = (const char*)&header;
+            out.insert(out.end(), bytes, bytes + sizeof(header));
+            bytes = (const char*)(answers.data() + owner.first);
+            out.insert(out.end(), bytes, bytes + owner.count * sizeof(BallisticAnswer));
+         }
+      }
+
+      // send what we can and let go of anyone who hung up
+      for (Client& client : clients)
+         if (!client.closed && !client.out.empty())
+            transmit(client);
+      for (size_t i = clients.size(); i-- > 0;)
+         if (clients[i].closed)
+         {
+            close(clients[i].fd);
+            clients.erase(clients.begin() + i);
+         }
+   }
+
+   for (const Client& client : clients)
+      close(client.fd);
+   close(listener);
+   unlink(path);
+   return 0;
+}
@@ -0,0 +1,93 @@
+/**********************************************************************
+ * Header File:
+ *    BALLISTIC PROTOCOL
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    What goes over the socket to the ballistic daemon. A batch is a
+ *    header and then that many fixed-size records, queries one way and
+ *    answers the other, in the order the queries were sent. Both ends
+ *    are on the same machine, so numbers are in its own byte order.
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#define BALLISTIC_MAGIC   0x514C4142         // "BALQ"
+#define BALLISTIC_VERSION 1
+#define BALLISTIC_SOCKET  "/tmp/ballisticd.sock"
+
+/**********************************************************************
+ * BALLISTIC QUERY KIND
+ ************************************************************************/
+enum BallisticQueryKind
+{
+   QUERY_IMPACT,     // where a shot comes down, from its elevation
+   QUERY_SOLUTION    // the elevations that hit a target
+};
+
+/**********************************************************************
+ * BALLISTIC STATUS
+ ************************************************************************/
+enum BallisticStatus
+{
+   STATUS_OK,
+   STATUS_NO_ANSWER,   // never comes down there, or out of reach
+   STATUS_BAD_QUERY    // unknown kind or ammunition, or a number that is not
+};
+
+/**********************************************************************
+ * BALLISTIC BATCH HEADER
+ * In front of every batch, both ways
+ ************************************************************************/
+struct BallisticBatchHeader
+{
+   uint32_t magic;      // BALLISTIC_MAGIC
+   uint16_t version;    // BALLISTIC_VERSION
+   uint16_t count;      // records that follow
+};
+
+/**********************************************************************
+ * BALLISTIC QUERY
+ ************************************************************************/
+struct BallisticQuery
+{
+   uint32_t id;             // handed back in the answer
+   uint8_t kind;            // BallisticQueryKind
+   uint8_t ammunition;      // AmmunitionType
+   uint16_t reserved;
+   double howitzerX;        // meters
+   double howitzerY;
+   double muzzleVelocity;   // m/s
+   double elevation;        // radians, QUERY_IMPACT only
+   double targetX;          // meters, QUERY_SOLUTION only
+   double targetY;          // meters. For QUERY_IMPACT, the altitude it lands at.
+};
+
+/**********************************************************************
+ * BALLISTIC ANSWER
+ ************************************************************************/
+struct BallisticAnswer
+{
+   uint32_t id;             // from the query
+   uint8_t kind;
+   uint8_t status;          // BallisticStatus
+   uint8_t cached;          // 1 if it was already known
+   uint8_t reserved;
+
+   // QUERY_IMPACT
+   double impactX;          // meters
+   double timeOfFlight;     // seconds
+   double impactSpeed;      // m/s
+
+   // QUERY_SOLUTION. NaN for an angle that does not reach.
+   double lowElevation;     // radians
+   double lowTimeOfFlight;  // seconds
+   double highElevation;
+   double highTimeOfFlight;
+};
+
+static_assert(sizeof(BallisticBatchHeader) == 8, "the batch header is 8 bytes on the wire");
+static_assert(sizeof(BallisticQuery) == 56, "a query is 56 bytes on the wire");
+static_assert(sizeof(BallisticAnswer) == 64, "an answer is 64 bytes on the wire");
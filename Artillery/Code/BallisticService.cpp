@@ -0,0 +1,228 @@
+/***********************************************************************
+ * Source File:
+ *    BALLISTIC SERVICE
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Cached, deduplicated, parallel answers to ballistic queries
+ ************************************************************************/
+
+#include "ballisticService.h"
+#include "firingSolution.h"
+#include "ammunition.h"
+#include "parallelFor.h"
+#include <cmath>
+#include <vector>
+using namespace std;
+
+#define SERVICE_CACHE_SIZE 65536   // answers kept
+
+/***********************************************************************
+ * BALLISTIC SERVICE :: CONSTRUCTOR
+ ************************************************************************/
+BallisticService::BallisticService() :
+   cacheSize(SERVICE_CACHE_SIZE),
+   threads(0),
+   hits(0),
+   misses(0)
+{
+}
+
+/***********************************************************************
+ * BALLISTIC SERVICE :: KEY ==
+ ************************************************************************/
+bool BallisticService::Key::operator == (const Key& rhs) const
+{
+   for (int i = 0; i < 7; i++)
+      if (values[i] != rhs.values[i])
+         return false;
+   return true;
+}
+
+/***********************************************************************
+ * BALLISTIC SERVICE :: KEY HASH
+ * FNV-1a over the words
+ ************************************************************************/
+size_t BallisticService::KeyHash::operator () (const Key& key) const
+{
+   uint64_t hash = 14695981039346656037ull;
+   for (int i = 0; i < 7; i++)
+   {
+      hash ^= (uint64_t)key.values[i];
+      hash *= 1099511628211ull;
+   }
+   return (size_t)hash;
+}
+
+/***********************************************************************
+ * BALLISTIC SERVICE :: KEY OF
+ * Only the fields the kind of query uses, so a solution query is not
+ * told apart by an elevation it never looks at
+ ************************************************************************/
+BallisticService::Key BallisticService::keyOf(const BallisticQuery& query)
+{
+   bool impact = query.kind == QUERY_IMPACT;
+   Key key;
+   key.values[0] = ((int64_t)query.kind << 8) | query.ammunition;
+   key.values[1] = llround(query.howitzerX * 10.0);
+   key.values[2] = llround(query.howitzerY * 10.0);
+   key.values[3] = llround(query.muzzleVelocity * 100.0);
+   key.values[4] = impact ? llround(query.elevation * 1e6) : 0;
+   key.values[5] = impact ? 0 : llround(query.targetX * 10.0);
+   key.values[6] = llround(query.targetY * 10.0);
+   return key;
+}
+
+/***********************************************************************
+ * BALLISTIC SERVICE :: IS VALID
+ * Only the fields the kind of query uses, the same ones keyOf does. An
+ * elevation in a solution query is ignored, not checked.
+ ************************************************************************/
+bool BallisticService::isValid(const BallisticQuery& query)
+{
+   if ((query.kind != QUERY_IMPACT && query.kind != QUERY_SOLUTION) ||
+       query.ammunition >= AMMUNITION_TYPES ||
+       !std::isfinite(query.howitzerX) || !std::isfinite(query.howitzerY) ||
+       !std::isfinite(query.targetY) || !(query.muzzleVelocity > 0.0) ||
+       !std::isfinite(query.muzzleVelocity))
+      return false;
+   if (query.kind == QUERY_IMPACT)
+      return std::isfinite(query.elevation);
+   return std::isfinite(query.targetX);
+}
+
+/***********************************************************************
+ * BALLISTIC SERVICE :: SOLVE
+ ************************************************************************/
+BallisticAnswer BallisticService::solve(const BallisticQuery& query)
+{
+   BallisticAnswer answer = {};
+   answer.id = query.id;
+   answer.kind = query.kind;
+   answer.status = STATUS_BAD_QUERY;
+   answer.impactX = answer.timeOfFlight = answer.impactSpeed = NAN;
+   answer.lowElevation = answer.lowTimeOfFlight = NAN;
+   answer.highElevation = answer.highTimeOfFlight = NAN;
+
+   if (!isValid(query))
+      return answer;
+
+   FiringSolver solver;
+   solver.setAmmunition((AmmunitionType)query.ammunition);
+   solver.setMuzzleVelocity(query.muzzleVelocity);
+
+   Position howitzer;
+   howitzer.setMetersX(query.howitzerX);
+   howitzer.setMetersY(query.howitzerY);
+   Position target;
+   target.setMetersX(query.targetX);
+   target.setMetersY(query.targetY);
+
+   answer.status = STATUS_NO_ANSWER;
+   if (query.kind == QUERY_IMPACT)
+   {
+      double timeOfFlight = 0.0;
+      double impactSpeed = 0.0;
+      double range = solver.range(query.elevation, howitzer, target, &timeOfFlight, &impactSpeed);
+      if (std::isnan(range))
+         return answer;
+      answer.impactX = query.howitzerX + (query.elevation < 0.0 ? -range : range);
+      answer.timeOfFlight = timeOfFlight;
+      answer.impactSpeed = impactSpeed;
+      answer.status = STATUS_OK;
+   }
+   else
+   {
+      FiringSolutions solutions = solver.solve(howitzer, target);
+      if (solutions.low.valid)
+      {
+         answer.lowElevation = solutions.low.elevation;
+         answer.lowTimeOfFlight = solutions.low.timeOfFlight;
+      }
+      if (solutions.high.valid)
+      {
+         answer.highElevation = solutions.high.elevation;
+         answer.highTimeOfFlight = solutions.high.timeOfFlight;
+      }
+      if (solutions.low.valid || solutions.high.valid)
+         answer.status = STATUS_OK;
+   }
+   return answer;
+}
+
+/***********************************************************************
+ * BALLISTIC SERVICE :: ANSWER
+ * Three passes: sort the batch into cache hits, repeats of a query
+ * earlier in the batch, and new work; fly the new work across every
+ * core; then remember it and fill in the repeats. A bad query is
+ * answered on the spot and never keyed, so it can neither be served
+ * from the cache nor put there.
+ ************************************************************************/
+void BallisticService::answer(const BallisticQuery* queries, size_t count,
+                              BallisticAnswer* answers)
+{
+   vector <size_t> work;                  // queries to fly
+   vector <size_t> firstAsked(count);     // where each query is first asked
+   unordered_map <Key, size_t, KeyHash> asked;
+   for (size_t i = 0; i < count; i++)
+   {
+      firstAsked[i] = i;
+      if (!isValid(queries[i]))
+      {
+         answers[i] = solve(queries[i]);
+         continue;
+      }
+
+      Key key = keyOf(queries[i]);
+      auto found = index.find(key);
+      if (found != index.end())
+      {
+         recent.splice(recent.begin(), recent, found->second);
+         answers[i] = found->second->second;
+         answers[i].id = queries[i].id;
+         answers[i].cached = 1;
+         hits++;
+         continue;
+      }
+
+      auto repeat = asked.find(key);
+      if (repeat != asked.end())
+      {
+         firstAsked[i] = repeat->second;
+         hits++;
+         continue;
+      }
+      asked[key] = i;
+      work.push_back(i);
+      misses++;
+   }
+
+   // fly the new ones. Each is independent, so threads take the next
+   // one until there are none left.
+   parallelFor(work.size(), threads, [&](size_t job)
+   {
+      answers[work[job]] = solve(queries[work[job]]);
+   });
+
+   // remember them, forgetting the least recently used
+   for (size_t i : work)
+   {
+      if (answers[i].status == STATUS_BAD_QUERY)
+         continue;
+      recent.push_front(make_pair(keyOf(queries[i]), answers[i]));
+      index[recent.front().first] = recent.begin();
+   }
+   while (recent.size() > cacheSize)
+   {
+      index.erase(recent.back().first);
+      recent.pop_back();
+   }
+
+   for (size_t i = 0; i < count; i++)
+      if (firstAsked[i] != i)
+      {
+         answers[i] = answers[firstAsked[i]];
+         answers[i].id = queries[i].id;
+         answers[i].cached = 1;
+      }
+}
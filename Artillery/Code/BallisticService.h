@@ -0,0 +1,71 @@
+/**********************************************************************
+ * Header File:
+ *    BALLISTIC SERVICE
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Answers batches of ballistic queries. The same questions come in
+ *    over and over, so recent answers are kept, the least recently used
+ *    going first when the cache is full. Within a batch, queries that
+ *    ask the same thing are flown once, and whatever is left is spread
+ *    over every core.
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>   // for size_t
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>   // for pair
+#include "ballisticProtocol.h"
+
+/**********************************************************************
+ * BALLISTIC SERVICE
+ * Cached, batched ballistic answers
+ ************************************************************************/
+class BallisticService
+{
+public:
+   BallisticService();
+
+   // setters
+   void setCacheSize(size_t cacheSize) { this->cacheSize = cacheSize; }
+   void setThreads(int threads) { this->threads = threads; }
+
+   // one answer per query, in the same order
+   void answer(const BallisticQuery* queries, size_t count, BallisticAnswer* answers);
+
+   // getters
+   size_t getHits() const { return hits; }
+   size_t getMisses() const { return misses; }
+
+   // fly one query, no cache
+   static BallisticAnswer solve(const BallisticQuery& query);
+
+private:
+   // what a query asks, to a tenth of a meter, a hundredth of a meter
+   // per second, and a microradian
+   struct Key
+   {
+      int64_t values[7];
+      bool operator == (const Key& rhs) const;
+   };
+   struct KeyHash
+   {
+      size_t operator () (const Key& key) const;
+   };
+   static Key keyOf(const BallisticQuery& query);
+
+   // every field the kind of query uses is there and a number
+   static bool isValid(const BallisticQuery& query);
+
+   typedef std::list <std::pair <Key, BallisticAnswer>> Recent;
+
+   Recent recent;   // most recently used first
+   std::unordered_map <Key, Recent::iterator, KeyHash> index;
+   size_t cacheSize;
+   int threads;     // 0 means one per core
+   size_t hits;
+   size_t misses;
+};
@@ -0,0 +1,472 @@
+/***********************************************************************
+ * Source File:
+ *    BALLISTICS
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Adaptive Dormand-Prince integration with ground and target events
+ ************************************************************************/
+
+#include "ballistics.h"
+#include "atmosphereTable.h"
+#include "ground.h"
+#include "terrainPyramid.h"
+#include "projectile.h"   // for DEFAULT_PROJECTILE_WEIGHT and GRAVITY
+#include "ammunition.h"
+#include <algorithm>   // for min and max
+#include <cmath>
+using namespace std;
+
+/***********************************************************************
+ * DERIVATIVE
+ * Rate of change of x, y, dx, and dy
+ ************************************************************************/
+template <class Scalar>
+static void derivative(const Ballistics& ballistics, const BasicBallisticState<Scalar>& state,
+                       Scalar f[4])
+{
+   f[0] = state.dx;
+   f[1] = state.dy;
+   ballistics.accelerate(state, f[2], f[3]);
+}
+
+/***********************************************************************
+ * COMBINE
+ * state + h * sum(weights[i] * k[i])
+ ************************************************************************/
+template <class Scalar>
+static BasicBallisticState<Scalar> combine(const BasicBallisticState<Scalar>& state, double h,
+                                           int count, const double weights[],
+                                           const Scalar k[][4])
+{
+   BasicBallisticState<Scalar> result = state;
+   Scalar sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+   for (int i = 0; i < count; i++)
+      for (int j = 0; j < 4; j++)
+         sum[j] += weights[i] * k[i][j];
+   result.x += h * sum[0];
+   result.y += h * sum[1];
+   result.dx += h * sum[2];
+   result.dy += h * sum[3];
+   return result;
+}
+
+/***********************************************************************
+ * INTERPOLATE
+ * Cubic Hermite between two states, fraction 0 to 1 of the way along.
+ * Position uses the velocities as slopes, velocity the accelerations.
+ ************************************************************************/
+template <class Scalar>
+static BasicBallisticState<Scalar> interpolate(const BasicBallisticState<Scalar>& s0,
+                                               const Scalar f0[4],
+                                               const BasicBallisticState<Scalar>& s1,
+                                               const Scalar f1[4], double fraction)
+{
+   double h = value(s1.t) - value(s0.t);
+   double u = fraction;
+   double h00 = (2.0 * u - 3.0) * u * u + 1.0;
+   double h10 = ((u - 2.0) * u + 1.0) * u;
+   double h01 = (3.0 - 2.0 * u) * u * u;
+   double h11 = (u - 1.0) * u * u;
+
+   BasicBallisticState<Scalar> state;
+   state.t = s0.t + u * h;
+   state.x = h00 * s0.x + h10 * h * f0[0] + h01 * s1.x + h11 * h * f1[0];
+   state.y = h00 * s0.y + h10 * h * f0[1] + h01 * s1.y + h11 * h * f1[1];
+   state.dx = h00 * s0.dx + h10 * h * f0[2] + h01 * s1.dx + h11 * h * f1[2];
+   state.dy = h00 * s0.dy + h10 * h * f0[3] + h01 * s1.dy + h11 * h * f1[3];
+   return state;
+}
+
+/***********************************************************************
+ * BALLISTICS
+ * An M795 round unless told otherwise
+ ************************************************************************/
+Ballistics::Ballistics() :
+   mass(DEFAULT_PROJECTILE_WEIGHT),
+   radius(DEFAULT_PROJECTILE_RADIUS),
+   drag(&M795::drag),
+   dragSlope(&M795::dragSlope),
+   tolerance(0.01),
+   maxStep(5.0),
+   stepSize(0.1),
+   steps(0)
+{
+}
+
+/***********************************************************************
+ * BALLISTICS :: SET AMMUNITION
+ ************************************************************************/
+void Ballistics::setAmmunition(const AmmunitionSpec& ammunition)
+{
+   mass = ammunition.mass;
+   radius = ammunition.radius;
+   drag = ammunition.drag;
+   dragSlope = ammunition.dragSlope;
+}
+
+/***********************************************************************
+ * BALLISTICS :: ACCELERATE
+ * The same forces as Projectile::advance. The tables only take doubles,
+ * so each lookup is chained with the slope of the line it read from.
+ ************************************************************************/
+template <class Scalar>
+void Ballistics::accelerate(const BasicBallisticState<Scalar>& state,
+                            Scalar& ddx, Scalar& ddy) const
+{
+   const double altitude = value(state.y);
+   Scalar speed = sqrt(state.dx * state.dx + state.dy * state.dy);
+   Scalar speedSound = chain(state.y, speedSoundFromAltitudeFast(altitude),
+                             speedSoundTable.slope(altitude));
+   Scalar mach = speed / speedSound;
+   Scalar dragCoefficient = chain(mach, drag(value(mach)), dragSlope(value(mach)));
+   Scalar airDensity = chain(state.y, densityFromAltitudeFast(altitude),
+                             densityTable.slope(altitude));
+
+   // forceFromDrag and accelerationFromForce, on any scalar
+   Scalar accelerationDrag = 0.5 * dragCoefficient * airDensity * speed * speed *
+                             (M_PI * radius * radius / mass);
+
+   bool moving = value(speed) != 0.0;
+   ddx = moving ? -accelerationDrag * (state.dx / speed) : Scalar(0.0);
+   ddy = GRAVITY - (moving ? accelerationDrag * (state.dy / speed) : Scalar(0.0));
+}
+
+/***********************************************************************
+ * BALLISTICS :: TRY STEP
+ * Dormand-Prince 5(4). The last stage is the derivative at the new
+ * state, so it is handed back to be the first stage of the next step.
+ ************************************************************************/
+template <class Scalar>
+double Ballistics::tryStep(const BasicBallisticState<Scalar>& state, const Scalar f0[4],
+                           double h, BasicBallisticState<Scalar>& next, Scalar f1[4]) const
+{
+   static const double a2[] = { 1.0 / 5.0 };
+   static const double a3[] = { 3.0 / 40.0, 9.0 / 40.0 };
+   static const double a4[] = { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0 };
+   static const double a5[] = { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0,
+                                -212.0 / 729.0 };
+   static const double a6[] = { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0,
+                                49.0 / 176.0, -5103.0 / 18656.0 };
+   static const double b[] = { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0,
+                               -2187.0 / 6784.0, 11.0 / 84.0 };
+   static const double e[] = { 71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0,
+                               -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0 };
+   static const double c[] = { 0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0 };
+
+   Scalar k[7][4];
+   for (int j = 0; j < 4; j++)
+      k[0][j] = f0[j];
+
+   const double* a[] = { a2, a3, a4, a5, a6 };
+   for (int stage = 1; stage < 6; stage++)
+   {
+      BasicBallisticState<Scalar> s = combine(state, h, stage, a[stage - 1], k);
+      s.t = state.t + c[stage] * h;
+      derivative(*this, s, k[stage]);
+   }
+
+   next = combine(state, h, 6, b, k);
+   next.t = state.t + h;
+   derivative(*this, next, k[6]);
+   for (int j = 0; j < 4; j++)
+      f1[j] = k[6][j];
+
+   // difference between the fifth and fourth order answers
+   double error = 0.0;
+   for (int j = 0; j < 4; j++)
+   {
+      double sum = 0.0;
+      for (int i = 0; i < 7; i++)
+         sum += e[i] * value(k[i][j]);
+      error = max(error, fabs(h * sum));
+   }
+   return error / tolerance;
+}
+
+/***********************************************************************
+ * BALLISTICS :: STEP
+ ************************************************************************/
+template <class Scalar>
+void Ballistics::step(BasicBallisticState<Scalar>& state, double h) const
+{
+   Scalar f0[4];
+   Scalar f1[4];
+   derivative(*this, state, f0);
+   BasicBallisticState<Scalar> next;
+   tryStep(state, f0, h, next, f1);
+   state = next;
+}
+
+/***********************************************************************
+ * BALLISTICS :: FIND EVENT
+ * Walk the cubic between two states in pieces no longer than spacing,
+ * so neither a hill nor the target box can hide between samples. The
+ * first piece that ends in an event is bisected down to the moment it
+ * starts. eventAt sees each piece from its start, so it can test the
+ * whole piece and not just where it ends.
+ ************************************************************************/
+template <class Event>
+BallisticEvent Ballistics::findEvent(const BallisticState& s0, const double f0[4],
+                                     const BallisticState& s1, const double f1[4],
+                                     Event eventAt, double spacing,
+                                     BallisticState& at) const
+{
+   double distance = max(fabs(s1.x - s0.x), fabs(s1.y - s0.y));
+   int pieces = (int)min(256.0, max(1.0, ceil(distance / spacing)));
+
+   double low = 0.0;
+   BallisticState from = s0;
+   for (int piece = 1; piece <= pieces; piece++)
+   {
+      double high = (double)piece / pieces;
+      BallisticState to = interpolate(s0, f0, s1, f1, high);
+      if (eventAt(from, to) == EVENT_NONE)
+      {
+         low = high;
+         from = to;
+         continue;
+      }
+
+      // bisect down to a microsecond
+      while ((high - low) * (s1.t - s0.t) > 1e-6)
+      {
+         double middle = (low + high) / 2.0;
+         BallisticState state = interpolate(s0, f0, s1, f1, middle);
+         if (eventAt(from, state) == EVENT_NONE)
+         {
+            low = middle;
+            from = state;
+         }
+         else
+            high = middle;
+      }
+      at = interpolate(s0, f0, s1, f1, high);
+      return eventAt(from, at);
+   }
+   return EVENT_NONE;
+}
+
+/***********************************************************************
+ * BALLISTICS :: INTEGRATE
+ ************************************************************************/
+template <class Event>
+BallisticEvent Ballistics::integrate(BallisticState& state, double duration,
+                                     Event eventAt, double spacing)
+{
+   const double end = state.t + duration;
+   double f0[4];
+   derivative(*this, state, f0);
+
+   while (state.t < end)
+   {
+      double h = min(min(stepSize, maxStep), end - state.t);
+      bool clipped = h < stepSize;
+
+      BallisticState next;
+      double f1[4];
+      double error = tryStep(state, f0, h, next, f1);
+      steps++;
+
+      // grow or shrink the step; the usual safety factor and limits
+      double factor = error > 0.0 ? 0.9 * pow(error, -0.2) : 5.0;
+      factor = max(0.2, min(5.0, factor));
+
+      // too much error: try again smaller
+      if (error > 1.0 && h > 1e-6)
+      {
+         stepSize = h * factor;
+         continue;
+      }
+      stepSize = clipped ? max(stepSize, h * factor) : h * factor;
+
+      BallisticState at;
+      BallisticEvent event = findEvent(state, f0, next, f1, eventAt, spacing, at);
+      if (event != EVENT_NONE)
+      {
+         state = at;
+         return event;
+      }
+
+      state = next;
+      for (int j = 0; j < 4; j++)
+         f0[j] = f1[j];
+   }
+   return EVENT_NONE;
+}
+
+/***********************************************************************
+ * BALLISTICS :: ADVANCE
+ * Stop in the target box or at the ground, the box winning a tie
+ ************************************************************************/
+BallisticEvent Ballistics::advance(BallisticState& state, double duration,
+                                   const Ground& ground, const Position& target)
+{
+   Position half;
+   half.setPixelsX(TARGET_HALF_PIXELS);
+   const double halfBox = half.getMetersX();
+
+   auto eventAt = [&](const BallisticState&, const BallisticState& s)
+   {
+      if (fabs(s.x - target.getMetersX()) <= halfBox &&
+          fabs(s.y - target.getMetersY()) <= halfBox)
+         return EVENT_TARGET;
+
+      Position pos;
+      pos.setMetersX(s.x);
+      pos.setMetersY(s.y);
+      if (ground.getElevationMeters(pos) >= s.y)
+         return EVENT_GROUND;
+      return EVENT_NONE;
+   };
+
+   return integrate(state, duration, eventAt, halfBox);
+}
+
+/***********************************************************************
+ * BALLISTICS :: ADVANCE
+ * Only on the way down, so a round that starts at the altitude (or
+ * climbs through it) keeps going. One piece per step is enough since
+ * altitude only crosses once on the way down.
+ ************************************************************************/
+BallisticEvent Ballistics::advance(BallisticState& state, double duration, double altitude)
+{
+   auto eventAt = [altitude](const BallisticState&, const BallisticState& s)
+   {
+      return (s.dy < 0.0 && s.y <= altitude) ? EVENT_GROUND : EVENT_NONE;
+   };
+
+   return integrate(state, duration, eventAt, HUGE_VAL);
+}
+
+/***********************************************************************
+ * BALLISTICS :: LAND
+ * Like advance to an altitude, but on dual numbers. The bisection only
+ * finds when the values cross, which is where the derivatives of the
+ * state are taken, but where the round lands also moves with the
+ * inputs. A last Newton step in time onto the altitude moves the value
+ * by less than a microsecond and puts that into the derivatives.
+ ************************************************************************/
+template <int N>
+bool Ballistics::land(BasicBallisticState<Dual<N>>& state, double duration, double altitude)
+{
+   typedef Dual<N> Scalar;
+   auto down = [altitude](const BasicBallisticState<Scalar>& s)
+   {
+      return value(s.dy) < 0.0 && value(s.y) <= altitude;
+   };
+
+   const double end = value(state.t) + duration;
+   Scalar f0[4];
+   derivative(*this, state, f0);
+
+   while (value(state.t) < end)
+   {
+      double h = min(min(stepSize, maxStep), end - value(state.t));
+      bool clipped = h < stepSize;
+
+      BasicBallisticState<Scalar> next;
+      Scalar f1[4];
+      double error = tryStep(state, f0, h, next, f1);
+      steps++;
+
+      double factor = error > 0.0 ? 0.9 * pow(error, -0.2) : 5.0;
+      factor = max(0.2, min(5.0, factor));
+      if (error > 1.0 && h > 1e-6)
+      {
+         stepSize = h * factor;
+         continue;
+      }
+      stepSize = clipped ? max(stepSize, h * factor) : h * factor;
+
+      if (!down(next))
+      {
+         state = next;
+         for (int j = 0; j < 4; j++)
+            f0[j] = f1[j];
+         continue;
+      }
+
+      // bisect down to a microsecond
+      double low = 0.0;
+      double high = 1.0;
+      while ((high - low) * h > 1e-6)
+      {
+         double middle = (low + high) / 2.0;
+         if (down(interpolate(state, f0, next, f1, middle)))
+            high = middle;
+         else
+            low = middle;
+      }
+      state = interpolate(state, f0, next, f1, high);
+
+      Scalar f[4];
+      derivative(*this, state, f);
+      Scalar shift = (altitude - state.y) / value(state.dy);
+      state.t += shift;
+      state.x += f[0] * shift;
+      state.y += f[1] * shift;
+      state.dx += f[2] * shift;
+      state.dy += f[3] * shift;
+      return true;
+   }
+   return false;
+}
+
+/***********************************************************************
+ * BALLISTICS :: ADVANCE
+ * The same, but every piece is a segment tested against the whole
+ * terrain under it, so a spike narrower than a piece is still found.
+ * Pieces are short enough that the chord is within centimeters of the
+ * curve.
+ ************************************************************************/
+BallisticEvent Ballistics::advance(BallisticState& state, double duration,
+                                   const TerrainPyramid& terrain, const Position& target)
+{
+   Position half;
+   half.setPixelsX(TARGET_HALF_PIXELS);
+   const double halfBox = half.getMetersX();
+
+   auto eventAt = [&](const BallisticState& from, const BallisticState& to)
+   {
+      if (fabs(to.x - target.getMetersX()) <= halfBox &&
+          fabs(to.y - target.getMetersY()) <= halfBox)
+         return EVENT_TARGET;
+
+      double fraction;
+      if (terrain.firstHit(from.x, from.y, to.x, to.y, fraction))
+         return EVENT_GROUND;
+      return EVENT_NONE;
+   };
+
+   return integrate(state, duration, eventAt, halfBox / 4.0);
+}
+
+/***********************************************************************
+ * BALLISTICS :: ADVANCE
+ * Without a box to find, pieces four times as long do. The chord is
+ * then within a couple of meters of the curve, and there are a quarter
+ * as many segments to test.
+ ************************************************************************/
+BallisticEvent Ballistics::advance(BallisticState& state, double duration,
+                                   const TerrainPyramid& terrain)
+{
+   Position half;
+   half.setPixelsX(TARGET_HALF_PIXELS);
+
+   auto eventAt = [&](const BallisticState& from, const BallisticState& to)
+   {
+      double fraction;
+      if (terrain.firstHit(from.x, from.y, to.x, to.y, fraction))
+         return EVENT_GROUND;
+      return EVENT_NONE;
+   };
+
+   return integrate(state, duration, eventAt, half.getMetersX());
+}
+
+// the scalars used outside this file
+template void Ballistics::accelerate(const BallisticState&, double&, double&) const;
+template bool Ballistics::land(BasicBallisticState<Dual<2>>&, double, double);
+template void Ballistics::step(BallisticState&, double) const;
+template void Ballistics::step(BasicBallisticState<Dual<4>>&, double) const;
@@ -0,0 +1,139 @@
+/**********************************************************************
+ * Header File:
+ *    BALLISTICS
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Flying a round with a step that fits the flight. Each step is a
+ *    Dormand-Prince 5(4) pair: the difference between the two answers
+ *    says how big the error was, and the next step grows or shrinks to
+ *    keep it under the tolerance. Between steps the path is a cubic, so
+ *    the exact moment a round meets the ground or enters the target box
+ *    is found by bisection instead of waiting for the next sample.
+ ************************************************************************/
+
+#pragma once
+
+#include "position.h"
+#include "dual.h"
+
+class Ground;
+class TerrainPyramid;
+struct AmmunitionSpec;
+
+#define TARGET_HALF_PIXELS 10.0   // the target box is 20 pixels across
+
+/**********************************************************************
+ * BALLISTIC STATE
+ * Where a round is, in meters, meters/second, and seconds. On Dual
+ * numbers it also carries how all of that depends on the inputs.
+ ************************************************************************/
+template <class Scalar>
+struct BasicBallisticState
+{
+   Scalar t;
+   Scalar x;
+   Scalar y;
+   Scalar dx;
+   Scalar dy;
+};
+
+typedef BasicBallisticState<double> BallisticState;
+
+/**********************************************************************
+ * BALLISTIC EVENT
+ * Why a flight stopped
+ ************************************************************************/
+enum BallisticEvent
+{
+   EVENT_NONE,      // still flying
+   EVENT_GROUND,    // hit the ground
+   EVENT_TARGET     // entered the target box
+};
+
+/**********************************************************************
+ * BALLISTICS
+ * Adaptive integration of one round
+ ************************************************************************/
+class Ballistics
+{
+public:
+   Ballistics();
+
+   // setters
+   void setMass(double mass) { this->mass = mass; }
+   void setRadius(double radius) { this->radius = radius; }
+   void setTolerance(double tolerance) { this->tolerance = tolerance; }
+   void setMaxStep(double maxStep) { this->maxStep = maxStep; }
+
+   // a different round: its mass, radius, and drag table
+   void setAmmunition(const AmmunitionSpec& ammunition);
+
+   // start a new flight
+   void reset() { stepSize = 0.1; steps = 0; }
+
+   // steps taken (accepted and rejected) since the last reset
+   int getSteps() const { return steps; }
+
+   // acceleration of a round in this state
+   template <class Scalar>
+   void accelerate(const BasicBallisticState<Scalar>& state, Scalar& ddx, Scalar& ddy) const;
+
+   // one step of h seconds with no error control, backward if h is
+   // negative. For following a round on a fixed grid of times.
+   template <class Scalar>
+   void step(BasicBallisticState<Scalar>& state, double h) const;
+
+   // fly for up to duration seconds. If the round meets the ground or
+   // enters the target box first, stop exactly there and say which.
+   BallisticEvent advance(BallisticState& state, double duration,
+                          const Ground& ground, const Position& target);
+
+   // the same against the terrain pyramid, which finds the ground
+   // between samples as well as at them
+   BallisticEvent advance(BallisticState& state, double duration,
+                          const TerrainPyramid& terrain, const Position& target);
+
+   // the terrain alone, when there is no target and meters will do:
+   // for sweeping many flights to see where they come down
+   BallisticEvent advance(BallisticState& state, double duration,
+                          const TerrainPyramid& terrain);
+
+   // fly for up to duration seconds, stopping exactly where the round
+   // comes down through an altitude. Reports EVENT_GROUND if it does.
+   BallisticEvent advance(BallisticState& state, double duration, double altitude);
+
+   // the same, carrying derivatives. Steps are sized from the values
+   // alone, and the derivatives are those of where the round actually
+   // comes down, time included. False if it does not.
+   template <int N>
+   bool land(BasicBallisticState<Dual<N>>& state, double duration, double altitude);
+
+private:
+   // one Dormand-Prince step of size h. Returns the error estimate.
+   template <class Scalar>
+   double tryStep(const BasicBallisticState<Scalar>& state, const Scalar f0[4], double h,
+                  BasicBallisticState<Scalar>& next, Scalar f1[4]) const;
+
+   // adaptive steps until eventAt says something happened
+   template <class Event>
+   BallisticEvent integrate(BallisticState& state, double duration,
+                            Event eventAt, double spacing);
+
+   // look for an event between two accepted states, sampling every
+   // spacing meters of travel
+   template <class Event>
+   BallisticEvent findEvent(const BallisticState& s0, const double f0[4],
+                            const BallisticState& s1, const double f1[4],
+                            Event eventAt, double spacing,
+                            BallisticState& at) const;
+
+   double mass;        // kg
+   double radius;      // m
+   double (*drag)(double mach);
+   double (*dragSlope)(double mach);
+   double tolerance;   // meters (and meters/second) of error per step
+   double maxStep;     // seconds
+   double stepSize;    // seconds, carried from one step to the next
+   int steps;
+};
@@ -0,0 +1,277 @@
+/***********************************************************************
+ * Source File:
+ *    BATCH PROJECTILE
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Many rounds advanced together
+ ************************************************************************/
+
+#include "batchProjectile.h"
+#include "ammunition.h"
+#include "atmosphereTable.h"
+#include "ground.h"
+#include "velocity.h"
+#include <cmath>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+using namespace std;
+
+/***********************************************************************
+ * BATCH PROJECTILE :: FIRE
+ ************************************************************************/
+size_t BatchProjectile::fire(const Position& posHowitzer, double simulationTime,
+                             const Angle& elevation, double muzzleVelocity,
+                             double mass, double radius)
+{
+   size_t i = size();
+   x.resize(i + 1);
+   y.resize(i + 1);
+   dx.resize(i + 1);
+   dy.resize(i + 1);
+   t.resize(i + 1);
+   active.resize(i + 1, 0.0);
+   this->mass.resize(i + 1);
+   this->radius.resize(i + 1);
+   density.resize(i + 1);
+   fire(i, posHowitzer, simulationTime, elevation, muzzleVelocity, mass, radius);
+   return i;
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: FIRE
+ * Reuse the slot of a round that has landed
+ ************************************************************************/
+void BatchProjectile::fire(size_t i, const Position& posHowitzer, double simulationTime,
+                           const Angle& elevation, double muzzleVelocity,
+                           double mass, double radius)
+{
+   Velocity v;
+   v.set(elevation, muzzleVelocity);
+
+   x[i] = posHowitzer.getMetersX();
+   y[i] = posHowitzer.getMetersY();
+   dx[i] = v.getDX();
+   dy[i] = v.getDY();
+   t[i] = simulationTime;
+   this->mass[i] = mass;
+   this->radius[i] = radius;
+   density[i] = 1.0;
+   if (active[i] == 0.0)
+      flying++;
+   active[i] = 1.0;
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: CLEAR
+ ************************************************************************/
+void BatchProjectile::clear()
+{
+   x.clear();
+   y.clear();
+   dx.clear();
+   dy.clear();
+   t.clear();
+   active.clear();
+   mass.clear();
+   radius.clear();
+   density.clear();
+   flying = 0;
+}
+
+/***********************************************************************
+ * EACH ROUND
+ * Rounds with their own mass and radius, all with a Round's drag
+ ************************************************************************/
+template <class Round>
+struct EachRound
+{
+   static double drag(double mach) { return Round::drag(mach); }
+   static double scale(const BatchProjectile& rounds, size_t i)
+   {
+      return M_PI * rounds.radius[i] * rounds.radius[i] / (2.0 * rounds.mass[i]);
+   }
+#ifdef __AVX2__
+   static __m256d drag(__m256d mach) { return Round::drag(mach); }
+   static __m256d scale4(const BatchProjectile& rounds, size_t i)
+   {
+      __m256d r = _mm256_loadu_pd(&rounds.radius[i]);
+      __m256d m = _mm256_loadu_pd(&rounds.mass[i]);
+      return _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(r, r), _mm256_set1_pd(M_PI)),
+                           _mm256_mul_pd(_mm256_set1_pd(2.0), m));
+   }
+#endif
+};
+
+/***********************************************************************
+ * EVERY ROUND
+ * Rounds that are all the same, so mass and radius are constants
+ ************************************************************************/
+template <class Round>
+struct EveryRound
+{
+   static double drag(double mach) { return Round::drag(mach); }
+   static double scale(const BatchProjectile&, size_t) { return Round::dragScale; }
+#ifdef __AVX2__
+   static __m256d drag(__m256d mach) { return Round::drag(mach); }
+   static __m256d scale4(const BatchProjectile&, size_t) { return _mm256_set1_pd(Round::dragScale); }
+#endif
+};
+
+/***********************************************************************
+ * BATCH PROJECTILE :: STEP ROUND
+ * One round, step for step the same as Projectile::advance. The drag
+ * deceleration divided by speed, rho Cd v dragScale, scales each
+ * velocity component directly.
+ ************************************************************************/
+template <class Rounds>
+void BatchProjectile::stepRound(size_t i, double simulationTime)
+{
+   if (active[i] == 0.0)
+      return;
+
+   double speed = sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+   double dragCoefficient = Rounds::drag(speed / speedSoundFromAltitudeFast(y[i]));
+   double airDensity = densityFromAltitudeFast(y[i]) * density[i];
+   double k = airDensity * dragCoefficient * speed * Rounds::scale(*this, i);
+
+   double ddx = -k * dx[i];
+   double ddy = GRAVITY - k * dy[i];
+
+   x[i] += dx[i] * simulationTime + 0.5 * ddx * simulationTime * simulationTime;
+   y[i] += dy[i] * simulationTime + 0.5 * ddy * simulationTime * simulationTime;
+   dx[i] += ddx * simulationTime;
+   dy[i] += ddy * simulationTime;
+   t[i] += simulationTime;
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: STEP
+ * Four rounds per instruction. Lanes whose round has landed compute
+ * along with the rest, then keep their old values.
+ ************************************************************************/
+template <class Rounds>
+void BatchProjectile::step(double simulationTime)
+{
+   const size_t n = size();
+   size_t i = 0;
+
+#ifdef __AVX2__
+   const __m256d vTime = _mm256_set1_pd(simulationTime);
+   const __m256d vHalfTime2 = _mm256_set1_pd(0.5 * simulationTime * simulationTime);
+   const __m256d vGravity = _mm256_set1_pd(GRAVITY);
+   const __m256d vZero = _mm256_setzero_pd();
+
+   for (; i + 4 <= n; i += 4)
+   {
+      __m256d mask = _mm256_cmp_pd(_mm256_loadu_pd(&active[i]), vZero, _CMP_NEQ_OQ);
+      if (_mm256_movemask_pd(mask) == 0)
+         continue;
+
+      __m256d px = _mm256_loadu_pd(&x[i]);
+      __m256d py = _mm256_loadu_pd(&y[i]);
+      __m256d vx = _mm256_loadu_pd(&dx[i]);
+      __m256d vy = _mm256_loadu_pd(&dy[i]);
+
+      __m256d speed = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy)));
+      __m256d drag = Rounds::drag(_mm256_div_pd(speed, speedSoundTable(py)));
+      __m256d airDensity = _mm256_mul_pd(densityTable(py), _mm256_loadu_pd(&density[i]));
+      __m256d k = _mm256_mul_pd(_mm256_mul_pd(airDensity, drag),
+                                _mm256_mul_pd(speed, Rounds::scale4(*this, i)));
+
+      __m256d ddx = _mm256_sub_pd(vZero, _mm256_mul_pd(k, vx));
+      __m256d ddy = _mm256_sub_pd(vGravity, _mm256_mul_pd(k, vy));
+
+      __m256d newX = _mm256_add_pd(px, _mm256_add_pd(_mm256_mul_pd(vx, vTime), _mm256_mul_pd(ddx, vHalfTime2)));
+      __m256d newY = _mm256_add_pd(py, _mm256_add_pd(_mm256_mul_pd(vy, vTime), _mm256_mul_pd(ddy, vHalfTime2)));
+      __m256d newDX = _mm256_add_pd(vx, _mm256_mul_pd(ddx, vTime));
+      __m256d newDY = _mm256_add_pd(vy, _mm256_mul_pd(ddy, vTime));
+      __m256d newT = _mm256_add_pd(_mm256_loadu_pd(&t[i]), _mm256_and_pd(mask, vTime));
+
+      _mm256_storeu_pd(&x[i], _mm256_blendv_pd(px, newX, mask));
+      _mm256_storeu_pd(&y[i], _mm256_blendv_pd(py, newY, mask));
+      _mm256_storeu_pd(&dx[i], _mm256_blendv_pd(vx, newDX, mask));
+      _mm256_storeu_pd(&dy[i], _mm256_blendv_pd(vy, newDY, mask));
+      _mm256_storeu_pd(&t[i], newT);
+   }
+#endif
+
+   for (; i < n; i++)
+      stepRound<Rounds>(i, simulationTime);
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: ADVANCE
+ * The drag table is looked up in the registry
+ ************************************************************************/
+void BatchProjectile::advance(double simulationTime, AmmunitionType ammunition)
+{
+   getAmmunition(ammunition).advanceEach(*this, simulationTime);
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: ADVANCE EACH
+ * Every round has a Round's drag, whatever its mass and radius
+ ************************************************************************/
+template <class Round>
+void BatchProjectile::advanceEach(double simulationTime)
+{
+   step<EachRound<Round>>(simulationTime);
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: ADVANCE
+ * Every round is a Round, whatever mass and radius say
+ ************************************************************************/
+template <class Round>
+void BatchProjectile::advance(double simulationTime)
+{
+   step<EveryRound<Round>>(simulationTime);
+}
+
+// one of each for each round in the registry
+template void BatchProjectile::advanceEach<M795>(double simulationTime);
+template void BatchProjectile::advance<M795>(double simulationTime);
+
+/***********************************************************************
+ * BATCH PROJECTILE :: RETIRE
+ ************************************************************************/
+void BatchProjectile::retire(size_t i)
+{
+   if (active[i] == 0.0)
+      return;
+   active[i] = 0.0;
+   flying--;
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: LAND
+ * The same test the simulation uses: flying while above the ground
+ ************************************************************************/
+size_t BatchProjectile::land(const Ground& ground)
+{
+   size_t landed = 0;
+   for (size_t i = 0; i < size(); i++)
+      if (active[i] != 0.0 && ground.getElevationMeters(getPosition(i)) >= y[i])
+      {
+         retire(i);
+         landed++;
+      }
+   return landed;
+}
+
+/***********************************************************************
+ * BATCH PROJECTILE :: LAND
+ ************************************************************************/
+size_t BatchProjectile::land(double altitude)
+{
+   size_t landed = 0;
+   for (size_t i = 0; i < size(); i++)
+      if (active[i] != 0.0 && y[i] <= altitude)
+      {
+         retire(i);
+         landed++;
+      }
+   return landed;
+}
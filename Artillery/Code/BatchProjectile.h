@@ -0,0 +1,99 @@
+/**********************************************************************
+ * Header File:
+ *    BATCH PROJECTILE
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Thousands of rounds flying at once, for planning. Each round takes
+ *    exactly the same step as Projectile::advance, but the rounds are
+ *    kept one array per component so four of them go through each AVX2
+ *    instruction. Rounds that reach the ground are retired by clearing
+ *    their active flag; they stay where they landed.
+ ************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "angle.h"
+#include "position.h"
+#include "projectile.h"   // for DEFAULT_PROJECTILE_WEIGHT and GRAVITY
+
+class Ground;
+
+/**********************************************************************
+ * BATCH PROJECTILE
+ * Many rounds, one array per component
+ ************************************************************************/
+class BatchProjectile
+{
+public:
+   BatchProjectile() : flying(0) {}
+
+   // fire another round. Returns its index.
+   size_t fire(const Position& posHowitzer, double simulationTime,
+               const Angle& elevation, double muzzleVelocity,
+               double mass = DEFAULT_PROJECTILE_WEIGHT,
+               double radius = DEFAULT_PROJECTILE_RADIUS);
+
+   // fire a round into the slot of one that has landed
+   void fire(size_t i, const Position& posHowitzer, double simulationTime,
+             const Angle& elevation, double muzzleVelocity,
+             double mass = DEFAULT_PROJECTILE_WEIGHT,
+             double radius = DEFAULT_PROJECTILE_RADIUS);
+
+   // take a round out of the air where it is
+   void retire(size_t i);
+
+   // forget every round
+   void clear();
+
+   // advance every active round by simulationTime seconds, each with
+   // its own mass and radius and the drag of one kind of round
+   void advance(double simulationTime, AmmunitionType ammunition = AMMUNITION_M795);
+
+   // the same with the drag of a Round (see ammunition.h) compiled in
+   template <class Round>
+   void advanceEach(double simulationTime);
+
+   // the same when every round is a Round, with its mass, radius, and
+   // drag table compiled in
+   template <class Round>
+   void advance(double simulationTime);
+
+   // retire every round that is at or below the ground. Returns how many.
+   size_t land(const Ground& ground);
+
+   // retire every round at or below an altitude. Returns how many.
+   size_t land(double altitude);
+
+   // getters
+   size_t size() const { return x.size(); }
+   size_t getFlying() const { return flying; }
+   bool isFlying(size_t i) const { return active[i] != 0.0; }
+   Position getPosition(size_t i) const
+   {
+      Position pos;
+      pos.setMetersX(x[i]);
+      pos.setMetersY(y[i]);
+      return pos;
+   }
+
+   // state of every round: meters, meters/second, and seconds
+   std::vector <double> x;
+   std::vector <double> y;
+   std::vector <double> dx;
+   std::vector <double> dy;
+   std::vector <double> t;
+   std::vector <double> active;   // 1 while flying, 0 once landed
+   std::vector <double> mass;     // kg
+   std::vector <double> radius;   // m
+   std::vector <double> density;  // multiple of the standard air density
+
+private:
+   template <class Rounds>
+   void step(double simulationTime);
+   template <class Rounds>
+   void stepRound(size_t i, double simulationTime);
+
+   size_t flying;                 // rounds still active
+};
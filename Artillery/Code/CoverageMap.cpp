@@ -0,0 +1,177 @@
+/***********************************************************************
+ * Source File:
+ *    COVERAGE MAP
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Parallel elevation sweep against the terrain pyramid
+ ************************************************************************/
+
+#include "coverageMap.h"
+#include "terrainPyramid.h"
+#include "ballistics.h"
+#include "howitzer.h"   // for DEFAULT_MUZZLE_VELOCITY
+#include "parallelFor.h"
+#include <algorithm>    // for min, max, and inplace_merge
+#include <cmath>
+using namespace std;
+
+#define COVERAGE_ELEVATIONS 128      // first sweep, each side
+#define COVERAGE_FLATTEST (M_PI_2 - 0.001)   // radians from straight up
+#define COVERAGE_SHADOW   1e-5       // radians: closer than this and a gap is a shadow
+#define COVERAGE_MAX_FLIGHT 600.0    // seconds
+#define COVERAGE_TOLERANCE  1.0      // meters per step; columns are 40 meters wide
+#define COVERAGE_STRIP    2.0        // pixels tall, the overlay
+#define COVERAGE_FOOTPRINT 1.0       // meters either side of the gun it stands on
+
+/***********************************************************************
+ * COVERAGE MAP :: CONSTRUCTOR
+ ************************************************************************/
+CoverageMap::CoverageMap() :
+   columnWidth(1.0),
+   muzzleVelocity(DEFAULT_MUZZLE_VELOCITY),
+   elevations(COVERAGE_ELEVATIONS),
+   threads(0),
+   flights(0)
+{
+}
+
+/***********************************************************************
+ * COVERAGE MAP :: FLY
+ * Each flight stops at the first piece of its path that touches the
+ * terrain. The muzzle is on top of the highest column under the gun;
+ * from any lower, every round would hit the side of that column as it
+ * left.
+ ************************************************************************/
+void CoverageMap::fly(vector <Shot>& shots, const Position& howitzer,
+                      const TerrainPyramid& terrain, const atomic <bool>* cancel) const
+{
+   const double x = howitzer.getMetersX();
+   const double y = max(howitzer.getMetersY(),
+                        terrain.maxHeight(x - COVERAGE_FOOTPRINT, x + COVERAGE_FOOTPRINT));
+
+   parallelFor(shots.size(), threads, [&](size_t i)
+   {
+      if (cancel && *cancel)
+         return;
+
+      Shot& shot = shots[i];
+      BallisticState state = { 0.0, x, y,
+                               muzzleVelocity * sin(shot.elevation),
+                               muzzleVelocity * cos(shot.elevation) };
+      Ballistics ballistics;
+      ballistics.setTolerance(COVERAGE_TOLERANCE);
+      if (ballistics.advance(state, COVERAGE_MAX_FLIGHT, terrain) == EVENT_GROUND)
+      {
+         shot.timeOfFlight = state.t;
+         shot.column = (long)floor(state.x / columnWidth);
+      }
+      else
+      {
+         shot.timeOfFlight = NAN;
+         shot.column = shot.elevation < 0.0 ? -1 : (long)heights.size();
+      }
+   });
+}
+
+/***********************************************************************
+ * COVERAGE MAP :: COMPUTE
+ * Each round of refinement flies the midpoints of every gap found in
+ * the last one, all together. Impact moves smoothly with elevation
+ * except where a flight grazes a hilltop, so a gap either closes or
+ * pinches down onto such a grazing shot: a shadow.
+ ************************************************************************/
+bool CoverageMap::compute(const Position& howitzer, const TerrainPyramid& terrain,
+                          const atomic <bool>* cancel)
+{
+   columnWidth = terrain.getColumnWidth();
+   const size_t columns = terrain.getColumns();
+   heights.resize(columns);
+   for (size_t i = 0; i < columns; i++)
+      heights[i] = terrain.height((i + 0.5) * columnWidth);
+   bands.assign(columns, vector <CoverageBand>());
+
+   // the first sweep: flat on the left, over the top, to flat on the right
+   vector <Shot> shots(2 * max(1, elevations));
+   for (size_t i = 0; i < shots.size(); i++)
+      shots[i].elevation = COVERAGE_FLATTEST * (2.0 * i / (shots.size() - 1) - 1.0);
+   fly(shots, howitzer, terrain, cancel);
+   flights = (int)shots.size();
+   if (cancel && *cancel)
+      return false;
+
+   // close the gaps
+   auto byElevation = [](const Shot& a, const Shot& b) { return a.elevation < b.elevation; };
+   while (true)
+   {
+      vector <Shot> middles;
+      for (size_t i = 0; i + 1 < shots.size(); i++)
+      {
+         const Shot& a = shots[i];
+         const Shot& b = shots[i + 1];
+         if (labs(a.column - b.column) > 1 && b.elevation - a.elevation > COVERAGE_SHADOW)
+         {
+            Shot middle;
+            middle.elevation = (a.elevation + b.elevation) / 2.0;
+            middles.push_back(middle);
+         }
+      }
+      if (middles.empty())
+         break;
+
+      fly(middles, howitzer, terrain, cancel);
+      flights += (int)middles.size();
+      if (cancel && *cancel)
+         return false;
+      shots.insert(shots.end(), middles.begin(), middles.end());
+      inplace_merge(shots.begin(), shots.end() - middles.size(), shots.end(), byElevation);
+   }
+
+   // neighboring elevations in the same column make one band
+   for (size_t i = 0; i < shots.size(); i++)
+   {
+      const Shot& shot = shots[i];
+      if (shot.column < 0 || shot.column >= (long)columns)
+         continue;
+
+      vector <CoverageBand>& column = bands[shot.column];
+      if (i > 0 && shots[i - 1].column == shot.column && !column.empty() &&
+          column.back().highElevation == shots[i - 1].elevation)
+      {
+         CoverageBand& band = column.back();
+         band.highElevation = shot.elevation;
+         band.shortestTime = min(band.shortestTime, shot.timeOfFlight);
+         band.longestTime = max(band.longestTime, shot.timeOfFlight);
+      }
+      else
+      {
+         CoverageBand band = { shot.elevation, shot.elevation,
+                               shot.timeOfFlight, shot.timeOfFlight };
+         column.push_back(band);
+      }
+   }
+
+   return true;
+}
+
+/***********************************************************************
+ * COVERAGE MAP :: DRAW
+ ************************************************************************/
+void CoverageMap::draw(ogstream& gout) const
+{
+   Position strip;
+   strip.setPixelsY(COVERAGE_STRIP);
+   const double tall = strip.getMetersY();
+
+   for (size_t i = 0; i < bands.size(); i++)
+      if (!bands[i].empty())
+      {
+         Position begin;
+         Position end;
+         begin.setMetersX(i * columnWidth);
+         begin.setMetersY(heights[i]);
+         end.setMetersX((i + 1) * columnWidth);
+         end.setMetersY(heights[i] + tall);
+         gout.drawRectangle(begin, end, 0.0 /*red*/, 1.0 /*green*/, 0.0 /*blue*/);
+      }
+}
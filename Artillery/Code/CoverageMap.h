@@ -0,0 +1,91 @@
+/**********************************************************************
+ * Header File:
+ *    COVERAGE MAP
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Which columns of the terrain the howitzer can reach from where it
+ *    is, at which elevations, and how long the round takes to get
+ *    there. A hill masks whatever is behind it from the flatter shots,
+ *    so only flights against the real terrain will tell.
+ *
+ *    A sweep of elevations on both sides is flown in parallel, each
+ *    flight tested against the terrain pyramid as it goes. Wherever two
+ *    neighboring elevations land more than a column apart, the
+ *    elevation halfway between is flown too, again in parallel, until
+ *    every column between them is covered or the gap is a shadow that
+ *    no elevation lands in.
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "position.h"
+#include "uiDraw.h"   // for ogstream
+
+class TerrainPyramid;
+
+/**********************************************************************
+ * COVERAGE BAND
+ * A run of elevations that all land in the same column
+ ************************************************************************/
+struct CoverageBand
+{
+   double lowElevation;    // radians, 0 is up and positive is right
+   double highElevation;
+   double shortestTime;    // seconds of flight
+   double longestTime;
+};
+
+/**********************************************************************
+ * COVERAGE MAP
+ * Reachable terrain, per column
+ ************************************************************************/
+class CoverageMap
+{
+public:
+   CoverageMap();
+
+   // setters
+   void setElevations(int elevations) { this->elevations = elevations; }
+   void setMuzzleVelocity(double muzzleVelocity) { this->muzzleVelocity = muzzleVelocity; }
+   void setThreads(int threads) { this->threads = threads; }
+
+   // everything the howitzer reaches over this terrain. If cancel is
+   // set meanwhile, it stops once the flights under way land and says
+   // false; what it has found so far is not a map.
+   bool compute(const Position& howitzer, const TerrainPyramid& terrain,
+                const std::atomic <bool>* cancel = NULL);
+
+   // getters
+   size_t getColumns() const { return bands.size(); }
+   const std::vector <CoverageBand>& getBands(size_t column) const { return bands[column]; }
+   bool isReachable(size_t column) const { return column < bands.size() && !bands[column].empty(); }
+   int getFlights() const { return flights; }
+
+   // a strip over every reachable column of the ground
+   void draw(ogstream& gout) const;
+
+private:
+   // where one elevation comes down
+   struct Shot
+   {
+      double elevation;
+      double timeOfFlight;
+      long column;        // may be off either side of the world
+   };
+
+   // fly every elevation in shots, spread over the cores, unless
+   // cancel is set
+   void fly(std::vector <Shot>& shots, const Position& howitzer,
+            const TerrainPyramid& terrain, const std::atomic <bool>* cancel) const;
+
+   std::vector <std::vector <CoverageBand>> bands;   // per column
+   std::vector <double> heights;                     // of the ground, per column
+   double columnWidth;      // meters
+   double muzzleVelocity;   // m/s
+   int elevations;          // in the first sweep, on each side
+   int threads;             // 0 means one per core
+   int flights;             // in the last compute
+};
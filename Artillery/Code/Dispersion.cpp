@@ -0,0 +1,164 @@
+/***********************************************************************
+ * Source File:
+ *    DISPERSION
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Monte Carlo dispersion of many imperfect rounds
+ ************************************************************************/
+
+#include "dispersion.h"
+#include "batchProjectile.h"
+#include "parallelFor.h"
+#include <algorithm>   // for nth_element, min, and max
+#include <cmath>
+#include <random>
+using namespace std;
+
+#define DISPERSION_CHUNK 4096     // rounds per generator
+#define DISPERSION_MAX_FLIGHT 1000.0   // seconds before a round is given up on
+
+/***********************************************************************
+ * MIX
+ * Scramble 64 bits (splitmix64) so nearby inputs give unrelated seeds
+ ************************************************************************/
+static uint64_t mix(uint64_t value)
+{
+   value += 0x9E3779B97F4A7C15ull;
+   value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+   value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+   return value ^ (value >> 31);
+}
+
+/***********************************************************************
+ * PERCENTILE
+ * Partially sorts values
+ ************************************************************************/
+static double percentile(vector <double>& values, double fraction)
+{
+   size_t index = (size_t)(fraction * (values.size() - 1) + 0.5);
+   nth_element(values.begin(), values.begin() + index, values.end());
+   return values[index];
+}
+
+/***********************************************************************
+ * DISPERSION ANALYSIS :: FLY CHUNK
+ * Fire every round of a chunk, then step them all until they come back
+ * down to the height of the gun. The impact is found between the last
+ * step above and the first step below.
+ ************************************************************************/
+void DispersionAnalysis::flyChunk(double elevation, double muzzleVelocity, uint64_t chunkSeed,
+                                  size_t count, double* range, double* deflection) const
+{
+   mt19937_64 generator(chunkSeed);
+   normal_distribution <double> normal(0.0, 1.0);
+
+   BatchProjectile batch;
+   vector <double> azimuth(count);
+   for (size_t i = 0; i < count; i++)
+   {
+      Angle angle;
+      angle.setRadians(elevation + model.sigmaElevation * normal(generator));
+      batch.fire(Position(), 0.0, angle,
+                 muzzleVelocity + model.sigmaMuzzleVelocity * normal(generator),
+                 DEFAULT_PROJECTILE_WEIGHT + model.sigmaMass * normal(generator));
+      batch.density[i] = max(0.0, 1.0 + model.sigmaDensity * normal(generator));
+      azimuth[i] = model.sigmaAzimuth * normal(generator);
+   }
+
+   vector <double> lastX(count);
+   vector <double> lastY(count);
+   for (double t = 0.0; batch.getFlying() > 0; t += timeStep)
+   {
+      lastX = batch.x;
+      lastY = batch.y;
+      batch.advance(timeStep);
+
+      for (size_t i = 0; i < count; i++)
+         if (batch.isFlying(i) && (batch.y[i] <= 0.0 || t > DISPERSION_MAX_FLIGHT))
+         {
+            double drop = lastY[i] - batch.y[i];
+            double fraction = drop > 0.0 ? lastY[i] / drop : 1.0;
+            range[i] = lastX[i] + fraction * (batch.x[i] - lastX[i]);
+            deflection[i] = range[i] * tan(azimuth[i]);
+         }
+      batch.land(t > DISPERSION_MAX_FLIGHT ? HUGE_VAL : 0.0);
+   }
+}
+
+/***********************************************************************
+ * DISPERSION ANALYSIS :: ANALYZE
+ ************************************************************************/
+DispersionResult DispersionAnalysis::analyze(const Angle& elevation, double muzzleVelocity) const
+{
+   return analyze(vector <Angle>(1, elevation), vector <double>(1, muzzleVelocity))[0];
+}
+
+/***********************************************************************
+ * DISPERSION ANALYSIS :: ANALYZE
+ * Every chunk of every aim point goes into one pool of work. Threads
+ * take the next chunk until there are none left, then the next aim
+ * point to summarize.
+ ************************************************************************/
+vector <DispersionResult> DispersionAnalysis::analyze(const vector <Angle>& elevations,
+                                                      const vector <double>& muzzleVelocities) const
+{
+   const size_t aims = elevations.size() * muzzleVelocities.size();
+   const size_t chunksPerAim = (rounds + DISPERSION_CHUNK - 1) / DISPERSION_CHUNK;
+   const size_t chunks = aims * chunksPerAim;
+
+   vector <DispersionResult> results(aims);
+   vector <vector <double>> ranges(aims, vector <double>(rounds));
+   vector <vector <double>> deflections(aims, vector <double>(rounds));
+   for (size_t aim = 0; aim < aims; aim++)
+   {
+      results[aim].elevation = elevations[aim % elevations.size()].getRadians();
+      results[aim].muzzleVelocity = muzzleVelocities[aim / elevations.size()];
+      results[aim].rounds = rounds;
+   }
+
+   // fly
+   parallelFor(chunks, threads, [&](size_t chunk)
+   {
+      size_t aim = chunk / chunksPerAim;
+      size_t first = (chunk % chunksPerAim) * DISPERSION_CHUNK;
+      size_t count = min((size_t)DISPERSION_CHUNK, rounds - first);
+      flyChunk(results[aim].elevation, results[aim].muzzleVelocity,
+               mix(seed ^ mix(chunk)), count,
+               &ranges[aim][first], &deflections[aim][first]);
+   });
+
+   // summarize
+   parallelFor(aims, threads, [&](size_t aim)
+   {
+      static const double fractions[DispersionResult::PERCENTILES] =
+         { 0.05, 0.25, 0.50, 0.75, 0.95 };
+
+      DispersionResult& result = results[aim];
+      vector <double>& range = ranges[aim];
+      vector <double>& deflection = deflections[aim];
+
+      double sumRange = 0.0;
+      double sumDeflection = 0.0;
+      for (size_t i = 0; i < rounds; i++)
+      {
+         sumRange += range[i];
+         sumDeflection += deflection[i];
+      }
+      result.meanRange = rounds ? sumRange / rounds : 0.0;
+      result.meanDeflection = rounds ? sumDeflection / rounds : 0.0;
+
+      vector <double> miss(rounds);
+      for (size_t i = 0; i < rounds; i++)
+         miss[i] = hypot(range[i] - result.meanRange, deflection[i] - result.meanDeflection);
+      result.cep = rounds ? percentile(miss, 0.5) : 0.0;
+
+      for (int p = 0; p < DispersionResult::PERCENTILES; p++)
+      {
+         result.range[p] = rounds ? percentile(range, fractions[p]) : 0.0;
+         result.deflection[p] = rounds ? percentile(deflection, fractions[p]) : 0.0;
+      }
+   });
+
+   return results;
+}
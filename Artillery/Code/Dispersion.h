@@ -0,0 +1,101 @@
+/**********************************************************************
+ * Header File:
+ *    DISPERSION
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    No two rounds land in the same place. Each round gets its own
+ *    muzzle velocity, elevation, azimuth, mass, and air density, drawn
+ *    from normal distributions, and every one of them is flown. The
+ *    impacts give the mean point of impact, the circular error probable
+ *    (CEP), and percentiles in range and deflection.
+ *
+ *    Rounds are drawn in fixed-size chunks and every chunk seeds its own
+ *    generator from the seed, the aim point, and the chunk number, so
+ *    the answer is the same no matter how many threads do the work.
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "angle.h"
+
+/**********************************************************************
+ * DISPERSION MODEL
+ * One standard deviation of each source of error
+ ************************************************************************/
+struct DispersionModel
+{
+   DispersionModel() :
+      sigmaMuzzleVelocity(1.5),
+      sigmaElevation(0.0005),
+      sigmaAzimuth(0.0005),
+      sigmaMass(0.15),
+      sigmaDensity(0.02) {}
+
+   double sigmaMuzzleVelocity;  // m/s
+   double sigmaElevation;       // radians
+   double sigmaAzimuth;         // radians
+   double sigmaMass;            // kg
+   double sigmaDensity;         // fraction of the standard air density
+};
+
+/**********************************************************************
+ * DISPERSION RESULT
+ * Where the rounds from one aim point landed, relative to the gun
+ ************************************************************************/
+struct DispersionResult
+{
+   static const int PERCENTILES = 5;   // 5, 25, 50, 75, and 95
+
+   double elevation;                   // radians, 0 is up
+   double muzzleVelocity;              // m/s
+   size_t rounds;                      // rounds flown
+   double meanRange;                   // meters down range
+   double meanDeflection;              // meters across
+   double cep;                         // meters, half the rounds land this close to the mean
+   double range[PERCENTILES];
+   double deflection[PERCENTILES];
+};
+
+/**********************************************************************
+ * DISPERSION ANALYSIS
+ * Fly many imperfect rounds per aim point
+ ************************************************************************/
+class DispersionAnalysis
+{
+public:
+   DispersionAnalysis() :
+      rounds(100000),
+      seed(1),
+      threads(0),
+      timeStep(0.5) {}
+
+   // setters
+   void setModel(const DispersionModel& model) { this->model = model; }
+   void setRounds(size_t rounds) { this->rounds = rounds; }
+   void setSeed(uint64_t seed) { this->seed = seed; }
+   void setTimeStep(double timeStep) { this->timeStep = timeStep; }
+
+   // number of worker threads. Zero means one per core.
+   void setThreads(int threads) { this->threads = threads; }
+
+   // fire from level ground at one aim point
+   DispersionResult analyze(const Angle& elevation, double muzzleVelocity) const;
+
+   // every elevation at every muzzle velocity, elevation changing fastest
+   std::vector <DispersionResult> analyze(const std::vector <Angle>& elevations,
+                                          const std::vector <double>& muzzleVelocities) const;
+
+private:
+   // impacts of one chunk of rounds
+   void flyChunk(double elevation, double muzzleVelocity, uint64_t chunkSeed,
+                 size_t count, double* range, double* deflection) const;
+
+   DispersionModel model;
+   size_t rounds;              // rounds per aim point
+   uint64_t seed;              // same seed, same answer
+   int threads;                // worker threads, 0 for one per core
+   double timeStep;            // seconds per step
+};
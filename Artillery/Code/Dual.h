@@ -0,0 +1,153 @@
+/**********************************************************************
+ * Header File:
+ *    DUAL
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Forward-mode automatic differentiation. A dual number is a value
+ *    and its derivatives by N inputs, and every operation on it applies
+ *    the chain rule as it goes. Code written for any scalar type, run
+ *    on Dual<N> instead of double, gives back exact derivatives of its
+ *    answer from the same single pass, with no finite differences.
+ ************************************************************************/
+
+#pragma once
+
+#include <cmath>
+
+/**********************************************************************
+ * DUAL
+ * A value and its derivatives
+ ************************************************************************/
+template <int N>
+struct Dual
+{
+   Dual() : value(0.0), d() {}
+   Dual(double value) : value(value), d() {}
+
+   // input i: its derivative by itself is one and by the others zero
+   static Dual input(double value, int i)
+   {
+      Dual x(value);
+      x.d[i] = 1.0;
+      return x;
+   }
+
+   Dual& operator += (const Dual& rhs)
+   {
+      value += rhs.value;
+      for (int i = 0; i < N; i++)
+         d[i] += rhs.d[i];
+      return *this;
+   }
+   Dual& operator -= (const Dual& rhs)
+   {
+      value -= rhs.value;
+      for (int i = 0; i < N; i++)
+         d[i] -= rhs.d[i];
+      return *this;
+   }
+   Dual& operator *= (const Dual& rhs)
+   {
+      for (int i = 0; i < N; i++)
+         d[i] = d[i] * rhs.value + value * rhs.d[i];
+      value *= rhs.value;
+      return *this;
+   }
+   Dual& operator /= (const Dual& rhs)
+   {
+      double inverse = 1.0 / rhs.value;
+      value *= inverse;
+      for (int i = 0; i < N; i++)
+         d[i] = (d[i] - value * rhs.d[i]) * inverse;
+      return *this;
+   }
+   Dual& operator += (double rhs) { value += rhs; return *this; }
+   Dual& operator -= (double rhs) { value -= rhs; return *this; }
+   Dual& operator *= (double rhs)
+   {
+      value *= rhs;
+      for (int i = 0; i < N; i++)
+         d[i] *= rhs;
+      return *this;
+   }
+   Dual& operator /= (double rhs) { return *this *= 1.0 / rhs; }
+
+   double value;
+   double d[N];
+};
+
+template <int N> inline Dual<N> operator - (const Dual<N>& x) { return Dual<N>() -= x; }
+
+template <int N> inline Dual<N> operator + (Dual<N> lhs, const Dual<N>& rhs) { return lhs += rhs; }
+template <int N> inline Dual<N> operator - (Dual<N> lhs, const Dual<N>& rhs) { return lhs -= rhs; }
+template <int N> inline Dual<N> operator * (Dual<N> lhs, const Dual<N>& rhs) { return lhs *= rhs; }
+template <int N> inline Dual<N> operator / (Dual<N> lhs, const Dual<N>& rhs) { return lhs /= rhs; }
+
+template <int N> inline Dual<N> operator + (Dual<N> lhs, double rhs) { return lhs += rhs; }
+template <int N> inline Dual<N> operator - (Dual<N> lhs, double rhs) { return lhs -= rhs; }
+template <int N> inline Dual<N> operator * (Dual<N> lhs, double rhs) { return lhs *= rhs; }
+template <int N> inline Dual<N> operator / (Dual<N> lhs, double rhs) { return lhs /= rhs; }
+
+template <int N> inline Dual<N> operator + (double lhs, Dual<N> rhs) { return rhs += lhs; }
+template <int N> inline Dual<N> operator - (double lhs, const Dual<N>& rhs) { return Dual<N>(lhs) -= rhs; }
+template <int N> inline Dual<N> operator * (double lhs, Dual<N> rhs) { return rhs *= lhs; }
+template <int N> inline Dual<N> operator / (double lhs, const Dual<N>& rhs) { return Dual<N>(lhs) /= rhs; }
+
+/**********************************************************************
+ * FUNCTIONS
+ * f(x) and f'(x) times the derivatives of x
+ ************************************************************************/
+template <int N>
+inline Dual<N> sqrt(const Dual<N>& x)
+{
+   Dual<N> y(std::sqrt(x.value));
+   double slope = y.value > 0.0 ? 0.5 / y.value : 0.0;
+   for (int i = 0; i < N; i++)
+      y.d[i] = slope * x.d[i];
+   return y;
+}
+
+template <int N>
+inline Dual<N> sin(const Dual<N>& x)
+{
+   Dual<N> y(std::sin(x.value));
+   double slope = std::cos(x.value);
+   for (int i = 0; i < N; i++)
+      y.d[i] = slope * x.d[i];
+   return y;
+}
+
+template <int N>
+inline Dual<N> cos(const Dual<N>& x)
+{
+   Dual<N> y(std::cos(x.value));
+   double slope = -std::sin(x.value);
+   for (int i = 0; i < N; i++)
+      y.d[i] = slope * x.d[i];
+   return y;
+}
+
+/**********************************************************************
+ * VALUE
+ * The plain number, for decisions (step size, which branch, when to
+ * stop) that should not depend on the derivatives
+ ************************************************************************/
+inline double value(double x) { return x; }
+template <int N> inline double value(const Dual<N>& x) { return x.value; }
+
+/**********************************************************************
+ * CHAIN
+ * f(x) from a function that only takes doubles, such as a table
+ * lookup, given f and its slope at the value of x
+ ************************************************************************/
+inline double chain(double, double f, double) { return f; }
+
+template <int N>
+inline Dual<N> chain(const Dual<N>& x, double f, double slope)
+{
+   Dual<N> y(f);
+   for (int i = 0; i < N; i++)
+      y.d[i] = slope * x.d[i];
+   return y;
+}
@@ -0,0 +1,237 @@
+/***********************************************************************
+ * Source File:
+ *    FIRING SOLUTION
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Low and high angle elevations to hit a target
+ ************************************************************************/
+
+#include "firingSolution.h"
+#include "ballistics.h"
+#include "ground.h"
+#include "velocity.h"
+#include <cmath>
+using namespace std;
+
+#define MAX_FLIGHT 600.0          // seconds before a round is given up on
+#define LOWEST_ELEVATION 0.001    // radians from straight up
+#define FLATTEST_ELEVATION (M_PI_2 - 0.001)
+
+/***********************************************************************
+ * FIRING SOLVER :: INTEGRATOR
+ ************************************************************************/
+Ballistics FiringSolver::integrator(double stepError) const
+{
+   Ballistics ballistics;
+   ballistics.setAmmunition(getAmmunition(ammunition));
+   ballistics.setMass(mass);
+   ballistics.setRadius(radius);
+   ballistics.setTolerance(stepError);
+   return ballistics;
+}
+
+/***********************************************************************
+ * FIRING SOLVER :: FLY
+ * One full flight to where it comes back down through the target's
+ * altitude, with stepError meters of error allowed per step
+ ************************************************************************/
+double FiringSolver::fly(double elevation, const Position& howitzer, const Position& target,
+                         double stepError, double* timeOfFlight, double* impactSpeed) const
+{
+   Angle angle;
+   angle.setRadians(elevation);
+   Velocity v;
+   v.set(angle, muzzleVelocity);
+
+   BallisticState state = { 0.0, howitzer.getMetersX(), howitzer.getMetersY(), v.getDX(), v.getDY() };
+   Ballistics ballistics = integrator(stepError);
+   if (ballistics.advance(state, MAX_FLIGHT, target.getMetersY()) == EVENT_NONE ||
+       fabs(state.y - target.getMetersY()) > 1.0)
+      return NAN;   // turned back down below the target
+
+   if (timeOfFlight)
+      *timeOfFlight = state.t;
+   if (impactSpeed)
+      *impactSpeed = sqrt(state.dx * state.dx + state.dy * state.dy);
+   return (state.x - howitzer.getMetersX()) * (elevation < 0.0 ? -1.0 : 1.0);
+}
+
+/***********************************************************************
+ * FIRING SOLVER :: RANGE
+ * The drag table has corners, which makes the step error estimates
+ * optimistic over a two minute flight, so each step is held to a
+ * thousandth of the tolerance.
+ ************************************************************************/
+double FiringSolver::range(double elevation, const Position& howitzer, const Position& target,
+                           double* timeOfFlight, double* impactSpeed) const
+{
+   return fly(elevation, howitzer, target, tolerance / 1000.0, timeOfFlight, impactSpeed);
+}
+
+/***********************************************************************
+ * FIRING SOLVER :: RANGE
+ * Elevation and muzzle velocity are the two inputs, and the velocity
+ * is built from them on dual numbers so every later step carries its
+ * derivatives by both.
+ ************************************************************************/
+Dual<2> FiringSolver::range(double elevation, const Position& howitzer, const Position& target,
+                            Dual<2>& timeOfFlight, double* impactSpeed) const
+{
+   Dual<2> angle = Dual<2>::input(elevation, 0);
+   Dual<2> speed = Dual<2>::input(muzzleVelocity, 1);
+
+   BasicBallisticState<Dual<2>> state;
+   state.t = 0.0;
+   state.x = howitzer.getMetersX();
+   state.y = howitzer.getMetersY();
+   state.dx = speed * sin(angle);
+   state.dy = speed * cos(angle);
+
+   Ballistics ballistics = integrator(tolerance / 1000.0);
+   if (!ballistics.land(state, MAX_FLIGHT, target.getMetersY()) ||
+       fabs(state.y.value - target.getMetersY()) > 1.0)
+   {
+      timeOfFlight = NAN;
+      return NAN;
+   }
+
+   timeOfFlight = state.t;
+   if (impactSpeed)
+      *impactSpeed = sqrt(state.dx.value * state.dx.value + state.dy.value * state.dy.value);
+   return (state.x - howitzer.getMetersX()) * (elevation < 0.0 ? -1.0 : 1.0);
+}
+
+/***********************************************************************
+ * FIRING SOLVER :: FIND ROOT
+ * Newton's method, with the slope of range by elevation from the same
+ * flight as the range, between an elevation that reaches past the
+ * target and one that falls short (or never gets high enough). Any
+ * step that would land outside the bracket, or a NaN, falls back to
+ * bisection, so the bracket always shrinks.
+ ************************************************************************/
+FiringSolution FiringSolver::findRoot(double inside, double outside, double distance,
+                                      const Position& howitzer, const Position& target) const
+{
+   double sign = target.getMetersX() < howitzer.getMetersX() ? -1.0 : 1.0;
+   double tInside = inside;
+   double tOutside = outside;
+
+   Dual<2> timeOfFlight;
+   double t = (tInside + tOutside) / 2.0;
+
+   FiringSolution solution;
+   for (int i = 0; i < 60; i++)
+   {
+      double impactSpeed = 0.0;
+      Dual<2> r = range(sign * t, howitzer, target, timeOfFlight, &impactSpeed);
+      double f = r.value - distance;
+
+      if (!std::isnan(f) && fabs(f) <= tolerance)
+      {
+         solution.valid = true;
+         solution.elevation = sign * t;
+         solution.timeOfFlight = timeOfFlight.value;
+         solution.impactSpeed = impactSpeed;
+         solution.miss = f;
+         return solution;
+      }
+
+      if (!std::isnan(f) && f > 0.0)
+         tInside = t;
+      else
+         tOutside = t;
+      if (fabs(tInside - tOutside) < 1e-9)
+         break;
+
+      // d(range)/d(elevation), with range measured toward the target
+      double slope = r.d[0] * sign;
+      double next = std::isnan(f) || slope == 0.0 ? NAN : t - f / slope;
+      t = (next - tInside) * (next - tOutside) < 0.0 ? next : (tInside + tOutside) / 2.0;
+   }
+   return solution;
+}
+
+/***********************************************************************
+ * FIRING SOLVER :: SOLVE
+ * Golden-section search for the elevation with the longest range, then
+ * one root on each side of it
+ ************************************************************************/
+FiringSolutions FiringSolver::solve(const Position& howitzer, const Position& target) const
+{
+   const double sign = target.getMetersX() < howitzer.getMetersX() ? -1.0 : 1.0;
+   const double distance = fabs(target.getMetersX() - howitzer.getMetersX());
+   const double ratio = (sqrt(5.0) - 1.0) / 2.0;
+
+   auto reach = [&](double t)
+   {
+      double r = fly(sign * t, howitzer, target, tolerance / 10.0, nullptr, nullptr);
+      return std::isnan(r) ? -HUGE_VAL : r;
+   };
+
+   // longest range, to a thousandth of a radian. This only splits the
+   // high answers from the low ones, so rough flights will do.
+   double a = LOWEST_ELEVATION;
+   double b = FLATTEST_ELEVATION;
+   double c = b - ratio * (b - a);
+   double d = a + ratio * (b - a);
+   double fc = reach(c);
+   double fd = reach(d);
+   while (b - a > 0.001)
+   {
+      if (fc > fd)
+      {
+         b = d;
+         d = c;
+         fd = fc;
+         c = b - ratio * (b - a);
+         fc = reach(c);
+      }
+      else
+      {
+         a = c;
+         c = d;
+         fc = fd;
+         d = a + ratio * (b - a);
+         fd = reach(d);
+      }
+   }
+   double best = fc > fd ? c : d;
+
+   FiringSolutions solutions;
+   solutions.maxRange = max(fc, fd);   // to within a few meters
+   if (solutions.maxRange < distance - tolerance)
+      return solutions;
+
+   solutions.high = findRoot(best, LOWEST_ELEVATION, distance, howitzer, target);
+   solutions.low = findRoot(best, FLATTEST_ELEVATION, distance, howitzer, target);
+   return solutions;
+}
+
+/***********************************************************************
+ * FIRING SOLVER :: SOLVE
+ * A solution only counts if the round actually gets to the target box
+ * without hitting the terrain first
+ ************************************************************************/
+FiringSolutions FiringSolver::solve(const Position& howitzer, const Position& target,
+                                    const Ground& ground) const
+{
+   FiringSolutions solutions = solve(howitzer, target);
+
+   // make sure nothing is in the way
+   for (FiringSolution* solution : { &solutions.low, &solutions.high })
+      if (solution->valid)
+      {
+         Angle angle;
+         angle.setRadians(solution->elevation);
+         Velocity v;
+         v.set(angle, muzzleVelocity);
+         BallisticState state = { 0.0, howitzer.getMetersX(), howitzer.getMetersY(),
+                                  v.getDX(), v.getDY() };
+
+         Ballistics ballistics = integrator(tolerance / 1000.0);
+         solution->valid = ballistics.advance(state, MAX_FLIGHT, ground, target) == EVENT_TARGET;
+      }
+
+   return solutions;
+}
@@ -0,0 +1,114 @@
+/**********************************************************************
+ * Header File:
+ *    FIRING SOLUTION
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Where to point the gun. Range first grows and then shrinks as the
+ *    barrel comes down from straight up, so most targets in reach have
+ *    two answers: a high arc and a low, flat one. The elevation for the
+ *    longest range splits the two, and each answer is then a root of
+ *    (range - distance) on its own side of it.
+ ************************************************************************/
+
+#pragma once
+
+#include "position.h"
+#include "howitzer.h"     // for DEFAULT_MUZZLE_VELOCITY
+#include "projectile.h"   // for DEFAULT_PROJECTILE_WEIGHT
+#include "dual.h"
+
+class Ground;
+
+/**********************************************************************
+ * FIRING SOLUTION
+ * One way to hit the target
+ ************************************************************************/
+struct FiringSolution
+{
+   FiringSolution() : valid(false), elevation(0.0), timeOfFlight(0.0),
+                      impactSpeed(0.0), miss(0.0) {}
+
+   bool valid;            // false if out of reach or blocked by terrain
+   double elevation;      // radians, 0 is up and positive is right
+   double timeOfFlight;   // seconds
+   double impactSpeed;    // m/s
+   double miss;           // meters short (negative) or long of the target
+};
+
+/**********************************************************************
+ * FIRING SOLUTIONS
+ * Both ways to hit the target
+ ************************************************************************/
+struct FiringSolutions
+{
+   FiringSolution low;    // flat trajectory
+   FiringSolution high;   // plunging trajectory
+   double maxRange;       // meters toward the target at the target's altitude
+};
+
+/**********************************************************************
+ * FIRING SOLVER
+ * Elevations that put a round on a target
+ ************************************************************************/
+class FiringSolver
+{
+public:
+   FiringSolver() :
+      muzzleVelocity(DEFAULT_MUZZLE_VELOCITY),
+      mass(DEFAULT_PROJECTILE_WEIGHT),
+      radius(DEFAULT_PROJECTILE_RADIUS),
+      ammunition(AMMUNITION_M795),
+      tolerance(1.0) {}
+
+   // setters
+   void setMuzzleVelocity(double muzzleVelocity) { this->muzzleVelocity = muzzleVelocity; }
+   void setMass(double mass) { this->mass = mass; }
+   void setRadius(double radius) { this->radius = radius; }
+
+   // a different round: its mass, radius, and drag
+   void setAmmunition(AmmunitionType ammunition)
+   {
+      this->ammunition = ammunition;
+      mass = getAmmunition(ammunition).mass;
+      radius = getAmmunition(ammunition).radius;
+   }
+
+   // meters of miss that count as a hit
+   void setTolerance(double tolerance) { this->tolerance = tolerance; }
+
+   // both solutions from the howitzer to the target over the terrain
+   FiringSolutions solve(const Position& howitzer, const Position& target,
+                         const Ground& ground) const;
+
+   // the same with nothing in the way
+   FiringSolutions solve(const Position& howitzer, const Position& target) const;
+
+   // meters down range where a round fired at elevation comes back down
+   // through the target's altitude, NaN if it never gets that high
+   double range(double elevation, const Position& howitzer, const Position& target,
+                double* timeOfFlight = nullptr, double* impactSpeed = nullptr) const;
+
+   // the same from one flight on dual numbers: range and time of flight,
+   // each with its derivatives by elevation (d[0]) and muzzle velocity (d[1])
+   Dual<2> range(double elevation, const Position& howitzer, const Position& target,
+                 Dual<2>& timeOfFlight, double* impactSpeed = nullptr) const;
+
+private:
+   // a round set up to fly with a given error allowed per step
+   Ballistics integrator(double stepError) const;
+
+   // range with a given error allowed per step
+   double fly(double elevation, const Position& howitzer, const Position& target,
+              double stepError, double* timeOfFlight, double* impactSpeed) const;
+
+   // root of range - distance between two elevations
+   FiringSolution findRoot(double inside, double outside, double distance,
+                           const Position& howitzer, const Position& target) const;
+
+   double muzzleVelocity;  // m/s
+   double mass;            // kg
+   double radius;          // m
+   AmmunitionType ammunition; // whose drag table to use
+   double tolerance;       // meters
+};
@@ -0,0 +1,578 @@
+/***********************************************************************
+ * Source File:
+ *    FIRING TABLE
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Generating, mapping, and interpolating binary firing tables
+ ************************************************************************/
+
+#include "firingTable.h"
+#include "firingSolution.h"
+#include "parallelFor.h"
+#include <algorithm>   // for min and max
+#include <cmath>
+#include <cstring>     // for memcpy
+#include <fstream>
+#include <random>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // !_WIN32
+using namespace std;
+
+/***********************************************************************
+ * FIRING TABLE LAYOUT
+ * Where each table starts, in floats after the header
+ ************************************************************************/
+struct FiringTableLayout
+{
+   FiringTableLayout(const FiringTableHeader& header)
+   {
+      size_t grid = (size_t)header.altitude.count * header.velocity.count;
+      ranges = 0;
+      timesOfFlight = ranges + grid * header.elevation.count;
+      maxRanges = timesOfFlight + grid * header.elevation.count;
+      bestElevations = maxRanges + grid;
+      highs = bestElevations + grid;
+      lows = highs + grid * header.inverseCount;
+      floats = lows + grid * header.inverseCount;
+   }
+
+   size_t bytes() const { return sizeof(FiringTableHeader) + floats * sizeof(float); }
+
+   size_t ranges;
+   size_t timesOfFlight;
+   size_t maxRanges;
+   size_t bestElevations;
+   size_t highs;
+   size_t lows;
+   size_t floats;
+};
+
+/***********************************************************************
+ * CELL
+ * Which two samples of an axis a value falls between, and how far
+ ************************************************************************/
+struct Cell
+{
+   size_t index;
+   size_t step;      // 1, or 0 on an axis with a single sample
+   double fraction;
+};
+
+/***********************************************************************
+ * LOCATE
+ * False if the value is off the end of the axis
+ ************************************************************************/
+static inline bool locate(const FiringTableAxis& axis, double value, Cell& cell)
+{
+   if (axis.count < 2)
+   {
+      cell.index = 0;
+      cell.step = 0;
+      cell.fraction = 0.0;
+      return true;
+   }
+
+   double position = (value - axis.first) / (axis.last - axis.first) * (axis.count - 1);
+   if (!(position >= 0.0 && position <= axis.count - 1))
+      return false;   // also catches NaN
+
+   cell.index = min((size_t)position, (size_t)axis.count - 2);
+   cell.step = 1;
+   cell.fraction = position - cell.index;
+   return true;
+}
+
+/***********************************************************************
+ * LERP
+ ************************************************************************/
+static inline double lerp(double a, double b, double fraction)
+{
+   return a + (b - a) * fraction;
+}
+
+/***********************************************************************
+ * LOOKUP 2
+ * Bilinear over velocity and altitude
+ ************************************************************************/
+static inline double lookup2(const float* table, const FiringTableHeader& header,
+                             const Cell& v, const Cell& a)
+{
+   const float* row = table + a.index * header.velocity.count + v.index;
+   const float* next = row + a.step * header.velocity.count;
+   return lerp(lerp(row[0], row[v.step], v.fraction),
+               lerp(next[0], next[v.step], v.fraction), a.fraction);
+}
+
+/***********************************************************************
+ * LOOKUP 3
+ * Trilinear over the fastest axis, velocity, and altitude
+ ************************************************************************/
+static inline double lookup3(const float* table, size_t count, const FiringTableHeader& header,
+                             const Cell& u, const Cell& v, const Cell& a)
+{
+   const size_t strideA = count * header.velocity.count;
+   const float* p00 = table + a.index * strideA + v.index * count + u.index;
+   const float* p01 = p00 + v.step * count;
+   const float* p10 = p00 + a.step * strideA;
+   const float* p11 = p10 + v.step * count;
+   return lerp(lerp(lerp(p00[0], p00[u.step], u.fraction),
+                    lerp(p01[0], p01[u.step], u.fraction), v.fraction),
+               lerp(lerp(p10[0], p10[u.step], u.fraction),
+                    lerp(p11[0], p11[u.step], u.fraction), v.fraction), a.fraction);
+}
+
+/***********************************************************************
+ * FIRING TABLE
+ ************************************************************************/
+FiringTable::FiringTable() :
+   header(nullptr),
+   ranges(nullptr),
+   timesOfFlight(nullptr),
+   maxRanges(nullptr),
+   bestElevations(nullptr),
+   highs(nullptr),
+   lows(nullptr),
+   mapped(nullptr),
+   mappedSize(0)
+{
+}
+
+/***********************************************************************
+ * FIRING TABLE :: ATTACH
+ * Check the header, then point each table at its part of the image
+ ************************************************************************/
+bool FiringTable::attach(const char* data, size_t size)
+{
+   if (size < sizeof(FiringTableHeader))
+      return false;
+
+   const FiringTableHeader* candidate = (const FiringTableHeader*)data;
+   if (candidate->magic != FIRING_TABLE_MAGIC ||
+       candidate->version != FIRING_TABLE_VERSION ||
+       candidate->elevation.count == 0 || candidate->velocity.count == 0 ||
+       candidate->altitude.count == 0 || candidate->inverseCount < 2)
+      return false;
+
+   FiringTableLayout layout(*candidate);
+   if (size < layout.bytes())
+      return false;
+
+   const float* tables = (const float*)(data + sizeof(FiringTableHeader));
+   header = candidate;
+   ranges = tables + layout.ranges;
+   timesOfFlight = tables + layout.timesOfFlight;
+   maxRanges = tables + layout.maxRanges;
+   bestElevations = tables + layout.bestElevations;
+   highs = tables + layout.highs;
+   lows = tables + layout.lows;
+   return true;
+}
+
+/***********************************************************************
+ * FIRING TABLE :: OPEN
+ * Map the file read-only so only the pages actually looked at are read,
+ * and every process using the same table shares them
+ ************************************************************************/
+bool FiringTable::open(const char* filename)
+{
+   close();
+
+#ifdef _WIN32
+   ifstream fin(filename, ios::binary | ios::ate);
+   if (!fin.is_open())
+      return false;
+   buffer.resize((size_t)fin.tellg());
+   fin.seekg(0);
+   if (!fin.read(buffer.data(), buffer.size()))
+      return false;
+   if (!attach(buffer.data(), buffer.size()))
+   {
+      close();
+      return false;
+   }
+#else // !_WIN32
+   int fd = ::open(filename, O_RDONLY);
+   if (fd < 0)
+      return false;
+
+   struct stat status;
+   if (fstat(fd, &status) != 0 || status.st_size <= 0)
+   {
+      ::close(fd);
+      return false;
+   }
+
+   void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   ::close(fd);
+   if (data == MAP_FAILED)
+      return false;
+
+   mapped = (const char*)data;
+   mappedSize = (size_t)status.st_size;
+   if (!attach(mapped, mappedSize))
+   {
+      close();
+      return false;
+   }
+#endif // !_WIN32
+   return true;
+}
+
+/***********************************************************************
+ * FIRING TABLE :: CLOSE
+ ************************************************************************/
+void FiringTable::close()
+{
+#ifndef _WIN32
+   if (mapped)
+      munmap((void*)mapped, mappedSize);
+#endif // !_WIN32
+   mapped = nullptr;
+   mappedSize = 0;
+   buffer.clear();
+   header = nullptr;
+}
+
+/***********************************************************************
+ * FIRING TABLE :: RANGE
+ ************************************************************************/
+double FiringTable::range(double elevation, double muzzleVelocity, double altitude,
+                          double* timeOfFlight) const
+{
+   Cell e, v, a;
+   if (!isOpen() ||
+       !locate(header->elevation, fabs(elevation), e) ||
+       !locate(header->velocity, muzzleVelocity, v) ||
+       !locate(header->altitude, altitude, a))
+      return NAN;
+
+   if (timeOfFlight)
+      *timeOfFlight = lookup3(timesOfFlight, header->elevation.count, *header, e, v, a);
+   double meters = lookup3(ranges, header->elevation.count, *header, e, v, a);
+   return elevation < 0.0 ? -meters : meters;
+}
+
+/***********************************************************************
+ * FIRING TABLE :: MAX RANGE
+ ************************************************************************/
+double FiringTable::maxRange(double muzzleVelocity, double altitude) const
+{
+   Cell v, a;
+   if (!isOpen() ||
+       !locate(header->velocity, muzzleVelocity, v) ||
+       !locate(header->altitude, altitude, a))
+      return NAN;
+   return lookup2(maxRanges, *header, v, a);
+}
+
+/***********************************************************************
+ * FIRING TABLE :: ELEVATION
+ ************************************************************************/
+double FiringTable::elevation(double range, double muzzleVelocity, double altitude,
+                              bool high) const
+{
+   Cell s, v, a;
+   if (!isOpen() ||
+       !locate(header->velocity, muzzleVelocity, v) ||
+       !locate(header->altitude, altitude, a))
+      return NAN;
+
+   double longest = lookup2(maxRanges, *header, v, a);
+   double fraction = fabs(range) / longest;
+   if (!(fraction <= 1.0))
+      return NAN;
+
+   FiringTableAxis inverse(0.0, 1.0, header->inverseCount);
+   if (!locate(inverse, sqrt(1.0 - fraction), s))
+      return NAN;
+   double radians = lookup3(high ? highs : lows, header->inverseCount, *header, s, v, a);
+   return range < 0.0 ? -radians : radians;
+}
+
+/***********************************************************************
+ * FIRING TABLE GENERATOR
+ * Every quarter degree, 10 m/s from 400 to 1000, and every 100 meters
+ * up to 4 km: about 7 MB, good to a few meters
+ ************************************************************************/
+FiringTableGenerator::FiringTableGenerator() :
+   elevationAxis(0.0, M_PI_2, 361),
+   velocityAxis(400.0, 1000.0, 61),
+   altitudeAxis(0.0, 4000.0, 41),
+   inverseCount(65),
+   samples(4096),
+   threads(0)
+{
+}
+
+/***********************************************************************
+ * FLY
+ * Full flight back down to the launch altitude
+ ************************************************************************/
+static double fly(double elevation, double muzzleVelocity, double altitude,
+                  double* timeOfFlight = nullptr)
+{
+   Position howitzer;
+   howitzer.setMetersX(0.0);
+   howitzer.setMetersY(altitude);
+   Position target;
+   target.setMetersX(1.0);
+   target.setMetersY(altitude);
+
+   FiringSolver solver;
+   solver.setMuzzleVelocity(muzzleVelocity);
+   solver.setTolerance(0.1);
+   return solver.range(elevation, howitzer, target, timeOfFlight);
+}
+
+/***********************************************************************
+ * FIRING TABLE GENERATOR :: FLY COLUMN
+ * Every elevation for one velocity and altitude. The longest range is
+ * refined from the best sample by golden-section search, then each
+ * inverse sample is a root between the two grid elevations around it.
+ ************************************************************************/
+void FiringTableGenerator::flyColumn(char* image, uint32_t iVelocity, uint32_t iAltitude) const
+{
+   const FiringTableHeader& header = *(const FiringTableHeader*)image;
+   FiringTableLayout layout(header);
+   float* tables = (float*)(image + sizeof(FiringTableHeader));
+   const size_t column = (size_t)iAltitude * header.velocity.count + iVelocity;
+   const double v = header.velocity.at(iVelocity);
+   const double a = header.altitude.at(iAltitude);
+   const uint32_t count = header.elevation.count;
+
+   // the forward table
+   vector <double> range(count);
+   for (uint32_t i = 0; i < count; i++)
+   {
+      double timeOfFlight = 0.0;
+      range[i] = fly(header.elevation.at(i), v, a, &timeOfFlight);
+      if (std::isnan(range[i]))
+         range[i] = timeOfFlight = 0.0;
+      tables[layout.ranges + column * count + i] = (float)range[i];
+      tables[layout.timesOfFlight + column * count + i] = (float)timeOfFlight;
+   }
+
+   // the longest range, between the samples on either side of the best
+   uint32_t iBest = (uint32_t)(max_element(range.begin(), range.end()) - range.begin());
+   double lo = header.elevation.at(iBest > 0 ? iBest - 1 : 0);
+   double hi = header.elevation.at(min(iBest + 1, count - 1));
+   const double ratio = (sqrt(5.0) - 1.0) / 2.0;
+   double c = hi - ratio * (hi - lo);
+   double d = lo + ratio * (hi - lo);
+   double fc = fly(c, v, a);
+   double fd = fly(d, v, a);
+   while (hi - lo > 1e-6)
+   {
+      if (fc > fd)
+      {
+         hi = d;
+         d = c;
+         fd = fc;
+         c = hi - ratio * (hi - lo);
+         fc = fly(c, v, a);
+      }
+      else
+      {
+         lo = c;
+         c = d;
+         fc = fd;
+         d = lo + ratio * (hi - lo);
+         fd = fly(d, v, a);
+      }
+   }
+   double best = fc > fd ? c : d;
+   double longest = max(max(fc, fd), range[iBest]);
+   if (range[iBest] > max(fc, fd))
+      best = header.elevation.at(iBest);
+   tables[layout.maxRanges + column] = (float)longest;
+   tables[layout.bestElevations + column] = (float)best;
+
+   // elevation for each inverse sample on both branches
+   FiringTableAxis inverse(0.0, 1.0, header.inverseCount);
+   for (int branch = 0; branch < 2; branch++)
+   {
+      bool high = branch == 0;
+      size_t offset = (high ? layout.highs : layout.lows) + column * header.inverseCount;
+      for (uint32_t j = 0; j < header.inverseCount; j++)
+      {
+         if (j == 0)
+         {
+            tables[offset + j] = (float)best;
+            continue;
+         }
+         double s = inverse.at(j);
+         double distance = longest * (1.0 - s * s);
+
+         // bracket from the forward table, walking away from the best
+         double inside = best;
+         double fInside = longest - distance;
+         double outside = high ? header.elevation.first : header.elevation.last;
+         double fOutside = (high ? range.front() : range.back()) - distance;
+         for (uint32_t i = 0; i < count; i++)
+         {
+            uint32_t k = high ? iBest - min(i, iBest) : min(iBest + i, count - 1);
+            double t = header.elevation.at(k);
+            if ((high && t >= best) || (!high && t <= best))
+               continue;
+            if (range[k] - distance <= 0.0)
+            {
+               outside = t;
+               fOutside = range[k] - distance;
+               break;
+            }
+            inside = t;
+            fInside = range[k] - distance;
+         }
+
+         // out of reach at this end of the elevation axis
+         if (fOutside > 0.0)
+         {
+            tables[offset + j] = NAN;
+            continue;
+         }
+
+         // Illinois
+         double t = inside;
+         int side = 0;
+         for (int i = 0; i < 60 && fabs(inside - outside) > 1e-9; i++)
+         {
+            t = fInside != fOutside ?
+               (outside * fInside - inside * fOutside) / (fInside - fOutside) :
+               (inside + outside) / 2.0;
+            double f = fly(t, v, a) - distance;
+            if (std::isnan(f))
+               f = -distance;
+            if (fabs(f) < 0.01)
+               break;
+            if (f > 0.0)
+            {
+               inside = t;
+               fInside = f;
+               if (side == 1)
+                  fOutside /= 2.0;
+               side = 1;
+            }
+            else
+            {
+               outside = t;
+               fOutside = f;
+               if (side == -1)
+                  fInside /= 2.0;
+               side = -1;
+            }
+         }
+         tables[offset + j] = (float)t;
+      }
+   }
+}
+
+/***********************************************************************
+ * FIRING TABLE GENERATOR :: MEASURE ERROR
+ * Interpolation is worst in the middle of a cell, so random cell
+ * centers are flown in full and compared with the table. This is the
+ * worst miss found, not a proof, but with a few thousand samples it is
+ * a good one.
+ ************************************************************************/
+void FiringTableGenerator::measureError(char* image) const
+{
+   FiringTableHeader& header = *(FiringTableHeader*)image;
+   FiringTable table;
+   table.attach(image, FiringTableLayout(header).bytes());
+
+   auto center = [](const FiringTableAxis& axis, uint32_t i)
+   {
+      return axis.count > 1 ? (axis.at(i) + axis.at(i + 1)) / 2.0 : axis.first;
+   };
+   auto cells = [](const FiringTableAxis& axis)
+   {
+      return max(1u, axis.count - 1);
+   };
+
+   // pick the cells up front so the answer does not depend on threads
+   struct Sample
+   {
+      double elevation;
+      double velocity;
+      double altitude;
+      double fraction;
+   };
+   mt19937_64 generator(header.samples);
+   vector <Sample> chosen(header.samples);
+   FiringTableAxis inverse(0.0, 1.0, header.inverseCount);
+   for (Sample& sample : chosen)
+   {
+      sample.elevation = center(header.elevation, generator() % cells(header.elevation));
+      sample.velocity = center(header.velocity, generator() % cells(header.velocity));
+      sample.altitude = center(header.altitude, generator() % cells(header.altitude));
+      double s = center(inverse, generator() % (header.inverseCount - 1));
+      sample.fraction = 1.0 - s * s;
+   }
+
+   vector <double> rangeError(chosen.size(), 0.0);
+   vector <double> elevationError(chosen.size(), 0.0);
+   parallelFor(chosen.size(), threads, [&](size_t i)
+   {
+      const Sample& sample = chosen[i];
+      double flown = fly(sample.elevation, sample.velocity, sample.altitude);
+      double looked = table.range(sample.elevation, sample.velocity, sample.altitude);
+      if (!std::isnan(flown) && !std::isnan(looked))
+         rangeError[i] = fabs(flown - looked);
+
+      double distance = sample.fraction *
+         table.maxRange(sample.velocity, sample.altitude);
+      for (bool high : { true, false })
+      {
+         double elevation = table.elevation(distance, sample.velocity, sample.altitude, high);
+         if (std::isnan(elevation))
+            continue;
+         flown = fly(elevation, sample.velocity, sample.altitude);
+         if (!std::isnan(flown))
+            elevationError[i] = max(elevationError[i], fabs(flown - distance));
+      }
+   });
+
+   header.rangeError = chosen.empty() ? 0.0 :
+      *max_element(rangeError.begin(), rangeError.end());
+   header.elevationError = chosen.empty() ? 0.0 :
+      *max_element(elevationError.begin(), elevationError.end());
+}
+
+/***********************************************************************
+ * FIRING TABLE GENERATOR :: GENERATE
+ * Columns (one velocity at one altitude) are independent, so threads
+ * take the next column until there are none left
+ ************************************************************************/
+bool FiringTableGenerator::generate(const char* filename) const
+{
+   FiringTableHeader header = {};
+   header.magic = FIRING_TABLE_MAGIC;
+   header.version = FIRING_TABLE_VERSION;
+   header.elevation = elevationAxis;
+   header.velocity = velocityAxis;
+   header.altitude = altitudeAxis;
+   header.inverseCount = max(2u, inverseCount);
+   header.samples = samples;
+
+   vector <char> image(FiringTableLayout(header).bytes());
+   memcpy(image.data(), &header, sizeof(header));
+
+   const size_t columns = (size_t)header.velocity.count * header.altitude.count;
+   parallelFor(columns, threads, [&](size_t column)
+   {
+      flyColumn(image.data(), (uint32_t)(column % header.velocity.count),
+                (uint32_t)(column / header.velocity.count));
+   });
+
+   measureError(image.data());
+
+   ofstream fout(filename, ios::binary);
+   if (!fout.is_open())
+      return false;
+   fout.write(image.data(), image.size());
+   return fout.good();
+}
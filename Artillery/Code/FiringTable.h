@@ -0,0 +1,168 @@
+/**********************************************************************
+ * Header File:
+ *    FIRING TABLE
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Firing data without flying anything. A generator flies every
+ *    elevation, muzzle velocity, and launch altitude on a grid once and
+ *    writes the ranges to a binary file, along with the inverse: the
+ *    elevation for a range on both the high and the low branch. At run
+ *    time the file is mapped into memory and every answer is a handful
+ *    of multiplies between the nearest grid points.
+ *
+ *    Range is measured back to the launch altitude. The inverse grid is
+ *    uniform in sqrt(1 - range / maxRange) rather than in range, since
+ *    elevation changes like a square root near the maximum range and is
+ *    a straight line in that variable.
+ *
+ *    The generator samples cells against full flights and stores the
+ *    worst miss it found, so a table knows how far to trust itself.
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cmath>     // for NAN
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define FIRING_TABLE_MAGIC 0x4C425446   // "FTBL"
+#define FIRING_TABLE_VERSION 1
+
+/**********************************************************************
+ * FIRING TABLE AXIS
+ * count evenly spaced samples from first to last
+ ************************************************************************/
+struct FiringTableAxis
+{
+   FiringTableAxis() : first(0.0), last(0.0), count(1) {}
+   FiringTableAxis(double first, double last, uint32_t count) :
+      first(first), last(last), count(count) {}
+
+   double at(uint32_t i) const
+   {
+      return count > 1 ? first + (last - first) * i / (count - 1) : first;
+   }
+
+   double first;
+   double last;
+   uint32_t count;
+};
+
+/**********************************************************************
+ * FIRING TABLE HEADER
+ * The start of the file. The tables follow as floats, elevation (or
+ * the inverse variable) changing fastest, then muzzle velocity, then
+ * altitude:
+ *    range[altitude][velocity][elevation]           meters
+ *    timeOfFlight[altitude][velocity][elevation]    seconds
+ *    maxRange[altitude][velocity]                   meters
+ *    bestElevation[altitude][velocity]              radians
+ *    high[altitude][velocity][inverse]              radians
+ *    low[altitude][velocity][inverse]               radians
+ ************************************************************************/
+struct FiringTableHeader
+{
+   uint32_t magic;
+   uint32_t version;
+   FiringTableAxis elevation;   // radians, 0 is up
+   FiringTableAxis velocity;    // m/s
+   FiringTableAxis altitude;    // meters
+   uint32_t inverseCount;       // samples from maximum range (0) to no range (1)
+   uint32_t samples;            // cells checked against full flights
+   double rangeError;           // worst range lookup miss found, meters
+   double elevationError;       // worst miss flying an elevation lookup, meters
+};
+
+/**********************************************************************
+ * FIRING TABLE
+ * A read-only view of a table file
+ ************************************************************************/
+class FiringTable
+{
+   friend class FiringTableGenerator;
+
+public:
+   FiringTable();
+   ~FiringTable() { close(); }
+   FiringTable(const FiringTable&) = delete;
+   FiringTable& operator = (const FiringTable&) = delete;
+
+   // map a table file. False if it is missing or not a firing table.
+   bool open(const char* filename);
+   void close();
+   bool isOpen() const { return header != nullptr; }
+
+   // the grid and how well it matches full flights. Only when open;
+   // the errors are NaN otherwise.
+   const FiringTableHeader& getHeader() const { assert(isOpen()); return *header; }
+   double getRangeError() const { return isOpen() ? header->rangeError : NAN; }
+   double getElevationError() const { return isOpen() ? header->elevationError : NAN; }
+
+   // the lookups are all NaN when no table is open
+
+   // meters down range back at the launch altitude, NaN off the table.
+   // Negative elevations fire to the left and give negative ranges.
+   double range(double elevation, double muzzleVelocity, double altitude,
+                double* timeOfFlight = nullptr) const;
+
+   // longest range, meters
+   double maxRange(double muzzleVelocity, double altitude) const;
+
+   // elevation to reach range meters (negative is to the left), on the
+   // high (plunging) or low (flat) branch. NaN if out of reach.
+   double elevation(double range, double muzzleVelocity, double altitude, bool high) const;
+
+private:
+   // point at a table image already in memory
+   bool attach(const char* data, size_t size);
+
+   const FiringTableHeader* header;
+   const float* ranges;
+   const float* timesOfFlight;
+   const float* maxRanges;
+   const float* bestElevations;
+   const float* highs;
+   const float* lows;
+
+   const char* mapped;          // what to unmap
+   size_t mappedSize;
+   std::vector <char> buffer;   // where there is no mmap
+};
+
+/**********************************************************************
+ * FIRING TABLE GENERATOR
+ * Flies the grid and writes a table file
+ ************************************************************************/
+class FiringTableGenerator
+{
+public:
+   FiringTableGenerator();
+
+   // setters
+   void setElevations(const FiringTableAxis& elevation) { this->elevationAxis = elevation; }
+   void setVelocities(const FiringTableAxis& velocity) { this->velocityAxis = velocity; }
+   void setAltitudes(const FiringTableAxis& altitude) { this->altitudeAxis = altitude; }
+   void setInverseCount(uint32_t inverseCount) { this->inverseCount = inverseCount; }
+   void setSamples(uint32_t samples) { this->samples = samples; }
+   void setThreads(int threads) { this->threads = threads; }
+
+   // fly everything and write it. False if the file cannot be written.
+   bool generate(const char* filename) const;
+
+private:
+   // fill in one velocity and altitude of a table image
+   void flyColumn(char* image, uint32_t iVelocity, uint32_t iAltitude) const;
+
+   // check random cell centers against full flights
+   void measureError(char* image) const;
+
+   FiringTableAxis elevationAxis;
+   FiringTableAxis velocityAxis;
+   FiringTableAxis altitudeAxis;
+   uint32_t inverseCount;
+   uint32_t samples;
+   int threads;                 // 0 means one per core
+};
@@ -0,0 +1,69 @@
+/***********************************************************************
+ * Source File:
+ *    FLIGHT TRACK
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Curvature-decimated record of a whole flight
+ ************************************************************************/
+
+#include "flightTrack.h"
+#include <cmath>
+#include <fstream>
+using namespace std;
+
+/***********************************************************************
+ * FLIGHT TRACK :: RECORD
+ * The newest sample replaces the one before it unless that one was kept
+ * for good. A sample is kept for good once its heading is more than the
+ * tolerance away from the last one kept.
+ ************************************************************************/
+void FlightTrack::record(const Position& pos, const Velocity& v, double t)
+{
+   if (!enabled)
+      return;
+
+   Sample sample = { t, pos.getMetersX(), pos.getMetersY(), v.getDX(), v.getDY() };
+
+   if (samples.empty())
+   {
+      samples.push_back(sample);
+      anchor = sample;
+      provisional = false;
+      return;
+   }
+
+   if (provisional)
+      samples.back() = sample;
+   else
+      samples.push_back(sample);
+
+   // how far has the heading turned since the last kept sample?
+   double cross = anchor.dx * sample.dy - anchor.dy * sample.dx;
+   double dot = anchor.dx * sample.dx + anchor.dy * sample.dy;
+   double turn = fabs(atan2(cross, dot));
+
+   provisional = turn <= tolerance;
+   if (!provisional)
+      anchor = sample;
+}
+
+/***********************************************************************
+ * FLIGHT TRACK :: WRITE
+ ************************************************************************/
+bool FlightTrack::write(const char* filename) const
+{
+   ofstream fout(filename);
+   if (fout.fail())
+      return false;
+
+   fout.precision(10);
+   fout << "t,x,y,dx,dy\n";
+   for (const Sample& sample : samples)
+      fout << sample.t << ','
+           << sample.x << ','
+           << sample.y << ','
+           << sample.dx << ','
+           << sample.dy << '\n';
+   return !fout.fail();
+}
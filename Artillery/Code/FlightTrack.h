@@ -0,0 +1,65 @@
+/**********************************************************************
+ * Header File:
+ *    FLIGHT TRACK
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The whole path of one round, for analysis after the shot. Keeping
+ *    every step is wasteful where the path is nearly straight, so a
+ *    sample is only kept once the heading has turned far enough from
+ *    the last one kept. The newest sample is always there, so the
+ *    track runs from the muzzle all the way to where the round is now.
+ ************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "position.h"
+#include "velocity.h"
+
+/**********************************************************************
+ * FLIGHT TRACK
+ * Curvature-decimated samples of one flight
+ ************************************************************************/
+class FlightTrack
+{
+public:
+   // one kept moment of the flight
+   struct Sample
+   {
+      double t;    // seconds
+      double x;    // meters
+      double y;
+      double dx;   // meters/second
+      double dy;
+   };
+
+   FlightTrack() : tolerance(0.005), enabled(false), provisional(false) {}
+
+   // start or stop recording. Off by default.
+   void enable(bool enabled) { this->enabled = enabled; }
+   bool isEnabled() const { return enabled; }
+
+   // radians the heading may turn before another sample is kept
+   void setTolerance(double tolerance) { this->tolerance = tolerance; }
+
+   // add one step of the flight
+   void record(const Position& pos, const Velocity& v, double t);
+
+   // forget the last flight
+   void clear() { samples.clear(); provisional = false; }
+
+   // getters
+   const std::vector <Sample>& getSamples() const { return samples; }
+   size_t size() const { return samples.size(); }
+
+   // write the track as comma separated t,x,y,dx,dy. False on failure.
+   bool write(const char* filename) const;
+
+private:
+   std::vector <Sample> samples;
+   Sample anchor;        // the last sample kept for good
+   double tolerance;     // radians of turn between kept samples
+   bool enabled;         // recording at all?
+   bool provisional;     // is the last sample only there because it is newest?
+};
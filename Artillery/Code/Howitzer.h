@@ -72,6 +72,9 @@ class Howitzer
       // get the elevation
       const Angle & getElevation() const { return elevation; }
 
+      // point the howitzer, 0 is up and positive is right
+      void setElevation(double radians) { elevation.setRadians(radians); }
+
    private:
       Position position;      // initial position of the projectile
       double muzzleVelocity;  // muzzle velocity, defaults to 827.0 m/s
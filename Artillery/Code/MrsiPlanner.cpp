@@ -0,0 +1,128 @@
+/***********************************************************************
+ * Source File:
+ *    MRSI PLANNER
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Scheduling rounds to land together
+ ************************************************************************/
+
+#include "mrsiPlanner.h"
+#include "firingSolution.h"
+#include "howitzer.h"   // for DEFAULT_MUZZLE_VELOCITY
+#include "parallelFor.h"
+#include <algorithm>    // for min, max, and sort
+#include <cmath>
+using namespace std;
+
+#define MRSI_SLOWEST_CHARGE 300.0   // m/s, the smallest charge
+#define MRSI_CHARGE_STEP      1.0   // m/s between charges
+#define MRSI_SLEW_RATE        0.2   // radians/second, about 11 degrees a second
+#define MRSI_RELOAD_TIME     12.0   // seconds, five rounds a minute
+#define MRSI_ROUNDS             4   // rounds to try for
+
+/***********************************************************************
+ * MRSI PLANNER :: CONSTRUCTOR
+ ************************************************************************/
+MrsiPlanner::MrsiPlanner() :
+   rounds(MRSI_ROUNDS),
+   slewRate(MRSI_SLEW_RATE),
+   reloadTime(MRSI_RELOAD_TIME),
+   threads(0)
+{
+   for (double v = MRSI_SLOWEST_CHARGE; v <= DEFAULT_MUZZLE_VELOCITY; v += MRSI_CHARGE_STEP)
+      charges.push_back(v);
+}
+
+/***********************************************************************
+ * MRSI PLANNER :: GAP
+ * The next round can go once the gun is loaded and laid, whichever
+ * takes longer
+ ************************************************************************/
+double MrsiPlanner::gap(double elevation0, double elevation1) const
+{
+   double slew = slewRate > 0.0 ? fabs(elevation1 - elevation0) / slewRate : 0.0;
+   return max(reloadTime, slew);
+}
+
+/***********************************************************************
+ * MRSI PLANNER :: PLAN
+ * Round i, fired first, and round j, fired next, land together when j
+ * goes tof(i) - tof(j) seconds after i. That has to be at least the gap
+ * between them. Sorted by time of flight, the best chain of k rounds
+ * starting at i follows on to some j with a best chain of k - 1, so
+ * longer chains are built from shorter ones. The plan takes as long as
+ * the first round's time of flight, so of the longest chains the one
+ * that starts with the shortest flight is chosen.
+ ************************************************************************/
+MrsiPlan MrsiPlanner::plan(const Position& howitzer, const Position& target,
+                           const Ground& ground) const
+{
+   MrsiPlan plan;
+
+   // every charge, both angles. Charges are independent, so threads
+   // take the next one until there are none left.
+   vector <FiringSolutions> solutions(charges.size());
+   parallelFor(charges.size(), threads, [&](size_t charge)
+   {
+      FiringSolver solver;
+      solver.setMuzzleVelocity(charges[charge]);
+      solutions[charge] = solver.solve(howitzer, target, ground);
+   });
+
+   // the candidates, longest flight first
+   vector <MrsiShot> candidates;
+   for (size_t charge = 0; charge < charges.size(); charge++)
+      for (const FiringSolution* solution : { &solutions[charge].high, &solutions[charge].low })
+         if (solution->valid)
+         {
+            MrsiShot shot;
+            shot.elevation = solution->elevation;
+            shot.muzzleVelocity = charges[charge];
+            shot.timeOfFlight = solution->timeOfFlight;
+            shot.fireTime = 0.0;
+            candidates.push_back(shot);
+         }
+   sort(candidates.begin(), candidates.end(),
+        [](const MrsiShot& a, const MrsiShot& b) { return a.timeOfFlight > b.timeOfFlight; });
+   plan.candidates = (int)candidates.size();
+   if (candidates.empty() || rounds < 1)
+      return plan;
+
+   // follow[k][i] is the round after i in a chain of k + 1 rounds
+   // starting at i, or -1 if there is no such chain
+   const int n = (int)candidates.size();
+   vector <vector <int>> follow(rounds, vector <int>(n, -1));
+   int bestLength = 1;
+   int bestFirst = n - 1;
+   for (int k = 1; k < rounds; k++)
+      for (int i = n - 1; i >= 0; i--)
+      {
+         for (int j = i + 1; j < n && follow[k][i] < 0; j++)
+            if ((k == 1 || follow[k - 1][j] >= 0) &&
+                candidates[i].timeOfFlight - candidates[j].timeOfFlight >=
+                   gap(candidates[i].elevation, candidates[j].elevation))
+               follow[k][i] = j;
+
+         // walking toward longer flights, the first one found is the quickest
+         if (follow[k][i] >= 0 && bestLength <= k)
+         {
+            bestLength = k + 1;
+            bestFirst = i;
+         }
+      }
+
+   // read the chain back out
+   const double impactTime = candidates[bestFirst].timeOfFlight;
+   int i = bestFirst;
+   for (int k = bestLength - 1; k >= 0; k--)
+   {
+      MrsiShot shot = candidates[i];
+      shot.fireTime = impactTime - shot.timeOfFlight;
+      plan.shots.push_back(shot);
+      if (k > 0)
+         i = follow[k][i];
+   }
+   plan.impactTime = impactTime;
+   return plan;
+}
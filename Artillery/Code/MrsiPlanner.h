@@ -0,0 +1,80 @@
+/**********************************************************************
+ * Header File:
+ *    MRSI PLANNER
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Multiple rounds, simultaneous impact: one gun fires several rounds
+ *    that all land on the target at the same instant. A round with a
+ *    longer time of flight goes first, and the next can only follow
+ *    once the gun is reloaded and has been moved to its elevation.
+ *
+ *    Every charge is solved for both its high and low angle, in
+ *    parallel. Each solution is a candidate with a time of flight.
+ *    Then the longest chain of candidates whose times of flight are far
+ *    enough apart to fire one after another is found by dynamic
+ *    programming. Of the longest chains, the quickest one wins.
+ ************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "position.h"
+
+class Ground;
+
+/**********************************************************************
+ * MRSI SHOT
+ * One round of the plan
+ ************************************************************************/
+struct MrsiShot
+{
+   double elevation;       // radians, 0 is up and positive is right
+   double muzzleVelocity;  // m/s, the charge
+   double timeOfFlight;    // seconds
+   double fireTime;        // seconds after the first round is fired
+};
+
+/**********************************************************************
+ * MRSI PLAN
+ * The firing schedule
+ ************************************************************************/
+struct MrsiPlan
+{
+   MrsiPlan() : impactTime(0.0), candidates(0) {}
+
+   std::vector <MrsiShot> shots;   // in the order they are fired
+   double impactTime;              // seconds after the first round is fired
+   int candidates;                 // solutions found to choose from
+};
+
+/**********************************************************************
+ * MRSI PLANNER
+ * Charges and elevations that land together
+ ************************************************************************/
+class MrsiPlanner
+{
+public:
+   MrsiPlanner();
+
+   // setters
+   void setCharges(const std::vector <double>& muzzleVelocities) { charges = muzzleVelocities; }
+   void setRounds(int rounds) { this->rounds = rounds; }
+   void setSlewRate(double slewRate) { this->slewRate = slewRate; }
+   void setReloadTime(double reloadTime) { this->reloadTime = reloadTime; }
+   void setThreads(int threads) { this->threads = threads; }
+
+   // the most rounds, up to the number asked for, that can land on the
+   // target together
+   MrsiPlan plan(const Position& howitzer, const Position& target, const Ground& ground) const;
+
+private:
+   // seconds between two shots at these elevations
+   double gap(double elevation0, double elevation1) const;
+
+   std::vector <double> charges;   // m/s
+   int rounds;                     // how many rounds to try for
+   double slewRate;                // radians/second the barrel can move
+   double reloadTime;              // seconds, at the least, between rounds
+   int threads;                    // 0 means one per core
+};
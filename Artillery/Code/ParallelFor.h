@@ -0,0 +1,59 @@
+/***********************************************************************
+ * Header File:
+ *    Parallel For
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Split a run of independent items across worker threads. Items
+ *    take very different times to fly, so instead of fixed slices each
+ *    thread takes the next item until there are none left.
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>   // for min and max
+#include <atomic>
+#include <cstddef>     // for size_t
+#include <thread>
+#include <vector>
+
+/************************************
+ * GET THREAD COUNT
+ * How many threads share count items: threads, or one per core when
+ * threads is zero, but never more threads than items
+ ************************************/
+inline size_t getThreadCount(size_t count, int threads)
+{
+   size_t numThreads = threads > 0 ? (size_t)threads :
+                                     std::max(1u, std::thread::hardware_concurrency());
+   return std::max((size_t)1, std::min(numThreads, count));
+}
+
+/************************************
+ * PARALLEL FOR
+ * Call work(i) once for every i in [0, count). A single thread runs
+ * on the calling thread.
+ ************************************/
+template <class Work>
+void parallelFor(size_t count, int threads, Work work)
+{
+   std::atomic <size_t> next(0);
+   auto take = [&]()
+   {
+      for (size_t i = next++; i < count; i = next++)
+         work(i);
+   };
+
+   size_t numThreads = getThreadCount(count, threads);
+   if (numThreads == 1)
+   {
+      take();
+      return;
+   }
+
+   std::vector <std::thread> workers;
+   for (size_t i = 0; i < numThreads; i++)
+      workers.push_back(std::thread(take));
+   for (auto& worker : workers)
+      worker.join();
+}
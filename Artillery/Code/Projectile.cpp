@@ -10,6 +10,8 @@
 #include "projectile.h"
 #include "angle.h"
 #include "uiDraw.h"
+#include "telemetry.h"
+#include "atmosphereTable.h"
 using namespace std;
 
 /***********************************************************************
@@ -20,14 +22,66 @@ void Projectile::fire(const Position& posHowitzer, double simulationTime,
    const Angle& elevation, double muzzleVelocity)
 {
    reset();
+   track.clear();
+   ballistics.reset();
 
    PositionVelocityTime pvt;
    pvt.pos = posHowitzer;
    pvt.t = simulationTime;
    pvt.v.set(elevation, muzzleVelocity);
    flightPath.push_back(pvt);
+   track.record(pvt.pos, pvt.v, pvt.t);
+   TELEMETRY(TELEMETRY_EVENT, TELEMETRY_FIRE, 0, pvt.t,
+             pvt.pos.getMetersX(), pvt.pos.getMetersY(), pvt.v.getDX(), pvt.v.getDY());
 }
 
+/***********************************************************************
+ * STEP
+ * Moves a state forward one step. The tables only take doubles, so
+ * each lookup is chained with the slope of the line it read from.
+ ************************************************************************/
+template <class Scalar>
+void Projectile::step(BasicBallisticState<Scalar>& state, double simulationTime,
+                      const AmmunitionSpec& ammunition, double mass, double radius)
+{
+   // Constants
+   const double altitude = value(state.y);
+   Scalar speed = sqrt(state.dx * state.dx + state.dy * state.dy);
+   Scalar mach = speed / chain(state.y, speedSoundFromAltitudeFast(altitude),
+                               speedSoundTable.slope(altitude));
+   Scalar dragCoefficient = chain(mach, ammunition.drag(value(mach)),
+                                  ammunition.dragSlope(value(mach)));
+   Scalar airDensity = chain(state.y, densityFromAltitudeFast(altitude),
+                             densityTable.slope(altitude));
+   //const double gravity = gravityFromAltitude(state.y);
+
+   // Calculate the acceleration due to drag: forceFromDrag and
+   // accelerationFromForce, on any scalar
+   Scalar accelerationDrag = 0.5 * dragCoefficient * airDensity * speed * speed *
+                             (M_PI * radius * radius / mass);
+
+   // Calculate the acceleration components due to drag
+   bool moving = value(speed) != 0.0;
+   Scalar dragAccelerationX = moving ? -accelerationDrag * (state.dx / speed) : Scalar(0.0);
+   Scalar dragAccelerationY = moving ? -accelerationDrag * (state.dy / speed) : Scalar(0.0);
+
+   // Calculate the new position
+   state.t += simulationTime;
+   state.x += state.dx * simulationTime +
+      0.5 * dragAccelerationX * simulationTime * simulationTime;
+   state.y += state.dy * simulationTime +
+      0.5 * (GRAVITY + dragAccelerationY) * simulationTime * simulationTime;
+
+   // Update the velocity
+   state.dx += dragAccelerationX * simulationTime;
+   state.dy += (GRAVITY + dragAccelerationY) * simulationTime;
+}
+
+// the game itself, and derivatives by two inputs
+template void Projectile::step(BallisticState&, double, const AmmunitionSpec&, double, double);
+template void Projectile::step(BasicBallisticState<Dual<2>>&, double, const AmmunitionSpec&,
+                               double, double);
+
 /***********************************************************************
  * ADVANCE
  * Advances the projectile forward in time.
@@ -41,55 +95,64 @@ void Projectile::advance(double simulationTime)
    }
 
    // Get the last state of the projectile
-   PositionVelocityTime lastState = flightPath.back();
+   const PositionVelocityTime& lastState = flightPath.back();
+   BallisticState state;
+   state.t = lastState.t;
+   state.x = lastState.pos.getMetersX();
+   state.y = lastState.pos.getMetersY();
+   state.dx = lastState.v.getDX();
+   state.dy = lastState.v.getDY();
 
-   // Constants
-   double speed = lastState.v.getSpeed();
-   const double dragCoefficient = dragFromMach(speed /
-      speedSoundFromAltitude(lastState.pos.getMetersY()));
-   const double airDensity = densityFromAltitude(lastState.pos.getMetersY());
-   //const double gravity = gravityFromAltitude(lastState.pos.getMetersY());
+   step(state, simulationTime, getAmmunition(ammunition), mass, radius);
 
-   // Calculate the drag force
-   double dragForce = forceFromDrag(airDensity, dragCoefficient,
-      DEFAULT_PROJECTILE_RADIUS, speed);
+   // Add the new state to the flight path
+   PositionVelocityTime newState;
+   newState.t = state.t;
+   newState.pos.setMetersX(state.x);
+   newState.pos.setMetersY(state.y);
+   newState.v.setDX(state.dx);
+   newState.v.setDY(state.dy);
 
-   // Calculate the acceleration due to drag
-   double accelerationDrag =
-      accelerationFromForce(dragForce, DEFAULT_PROJECTILE_WEIGHT);
+   TELEMETRY(TELEMETRY_STEP, TELEMETRY_ADVANCE, (uint32_t)flightPath.size(), state.t,
+             state.x, state.y, state.dx, state.dy);
+   flightPath.push_back(newState);
+   track.record(newState.pos, newState.v, newState.t);
+}
 
-   // Calculate the acceleration components due to drag
-   double dragAccelerationX = (speed != 0) ? -accelerationDrag *
-      (lastState.v.getDX() / speed) : 0;
-   double dragAccelerationY = (speed != 0) ? accelerationDrag *
-      (lastState.v.getDY() / speed) : 0;
+/***********************************************************************
+ * ADVANCE
+ * Advances the projectile forward in time with adaptive steps, stopping
+ * early at the ground or the target.
+ ************************************************************************/
+BallisticEvent Projectile::advance(double simulationTime, const TerrainPyramid& terrain,
+                                   const Position& target)
+{
+   if (flightPath.empty())
+      return EVENT_NONE;
+
+   const PositionVelocityTime& lastState = flightPath.back();
+   BallisticState state;
+   state.t = lastState.t;
+   state.x = lastState.pos.getMetersX();
+   state.y = lastState.pos.getMetersY();
+   state.dx = lastState.v.getDX();
+   state.dy = lastState.v.getDY();
 
-   // Calculate the new time
-   double newTime = lastState.t + simulationTime;
+   ballistics.setAmmunition(getAmmunition(ammunition));
+   ballistics.setMass(mass);
+   ballistics.setRadius(radius);
+   BallisticEvent event = ballistics.advance(state, simulationTime, terrain, target);
 
-   // Calculate the new velocity
    PositionVelocityTime newState;
-   newState.t = newTime;
-   double newPositionX = lastState.pos.getMetersX() + lastState.v.getDX() *
-      simulationTime + 0.5 * dragAccelerationX * simulationTime * simulationTime;
-   double newPositionY = lastState.pos.getMetersY() + lastState.v.getDY() *
-      simulationTime + 0.5 * (GRAVITY - dragAccelerationY) * simulationTime * simulationTime;
-   newState.pos.setMetersX(newPositionX);
-   newState.pos.setMetersY(newPositionY);
-
-   // Update vertical position and velocity
-   double newVelocityX = lastState.v.getDX() +
-      dragAccelerationX * simulationTime;
-   double newVelocityY = lastState.v.getDY() +
-      (GRAVITY - dragAccelerationY) * simulationTime;
-   newState.v.setDX(newVelocityX);
-   newState.v.setDY(newVelocityY);
+   newState.t = state.t;
+   newState.pos.setMetersX(state.x);
+   newState.pos.setMetersY(state.y);
+   newState.v.setDX(state.dx);
+   newState.v.setDY(state.dy);
 
-   // Add the new state to the flight path
-   cout << flightPath.size() << " " << newState.pos.getMetersY() << endl;
+   TELEMETRY(TELEMETRY_STEP, TELEMETRY_ADVANCE, (uint32_t)flightPath.size(), state.t,
+             state.x, state.y, state.dx, state.dy);
    flightPath.push_back(newState);
-   while (flightPath.size() > 10)
-   {
-      flightPath.pop_front();
-   }
+   track.record(newState.pos, newState.v, newState.t);
+   return event;
 }
@@ -9,15 +9,22 @@
 
 #pragma once
 
-#include <list>
 #include "position.h"
 #include "velocity.h"
 #include "physics.h"
 #include "uiDraw.h"
+#include "ringBuffer.h"
+#include "flightTrack.h"
+#include "ballistics.h"
+#include "ammunition.h"
 
 #define DEFAULT_PROJECTILE_WEIGHT 46.7       // kg
 #define DEFAULT_PROJECTILE_RADIUS 0.077545   // m
 #define GRAVITY -9.8064
+#define FLIGHT_PATH_LENGTH 10                // points drawn behind the round
+
+static_assert(M795::mass == DEFAULT_PROJECTILE_WEIGHT && M795::radius == DEFAULT_PROJECTILE_RADIUS,
+              "the default projectile is an M795");
 
  // forward declaration for the unit test class
 class TestProjectile;
@@ -33,19 +40,32 @@ public:
    friend::TestProjectile;
 
    // create a new projectile with the default settings
-   Projectile() : mass(DEFAULT_PROJECTILE_WEIGHT), radius(DEFAULT_PROJECTILE_RADIUS), flightPath() {}
+   Projectile() : mass(DEFAULT_PROJECTILE_WEIGHT), radius(DEFAULT_PROJECTILE_RADIUS),
+                  ammunition(AMMUNITION_M795), flightPath() {}
 
-   // reset the game
+   // reset the game. The full track is kept so it can be looked at
+   // after the round lands.
    void reset()
    {
       flightPath.clear();
-      mass = DEFAULT_PROJECTILE_WEIGHT;
-      radius = DEFAULT_PROJECTILE_RADIUS;
+      mass = getAmmunition(ammunition).mass;
+      radius = getAmmunition(ammunition).radius;
    }
 
    // advance the round forward until the next unit of time
    void advance(double simulationTime);
 
+   // one step of the same physics on any scalar, so it can run on Dual
+   // numbers and carry derivatives by whatever the state started from
+   template <class Scalar>
+   static void step(BasicBallisticState<Scalar>& state, double simulationTime,
+                    const AmmunitionSpec& ammunition, double mass, double radius);
+
+   // same, with as many adaptive steps as it takes. Stops exactly where
+   // the round meets the terrain or enters the target box, if it does.
+   BallisticEvent advance(double simulationTime, const TerrainPyramid& terrain,
+                          const Position& target);
+
    // getters
    double getAltitude() const { return isFlying() ? flightPath.back().pos.getMetersY() : 0; }
    Position getPosition() const { return isFlying() ? flightPath.back().pos : Position(); }
@@ -61,18 +81,32 @@ public:
    double getSpeed() const { return isFlying() ? flightPath.back().v.getSpeed() : 0.0; }
    double getCurrentTime() const { return isFlying() ? flightPath.back().t : 0.0; }
 
+   AmmunitionType getAmmunitionType() const { return ammunition; }
+
    // setters
    void setMass(double mass) { this->mass = mass; }
    void setRadius(double radius) { this->radius = radius; }
 
+   // a different round: its mass, radius, and drag
+   void setAmmunition(AmmunitionType ammunition)
+   {
+      this->ammunition = ammunition;
+      mass = getAmmunition(ammunition).mass;
+      radius = getAmmunition(ammunition).radius;
+   }
+
+   // keep the whole flight, decimated, not just the drawn tail
+   void setRecording(bool recording) { track.enable(recording); }
+   const FlightTrack& getTrack() const { return track; }
+
    // are we flying?
    bool isFlying() const { return !flightPath.empty(); }
 
    // draw the projectile
    void draw(ogstream& gout) const
    {
-      for (auto it = flightPath.cbegin(); it != flightPath.cend(); ++it)
-         gout.drawProjectile(it->pos, getCurrentTime() - it->t);
+      for (size_t i = 0; i < flightPath.size(); i++)
+         gout.drawProjectile(flightPath[i].pos, getCurrentTime() - flightPath[i].t);
    }
 
    // fire the projectile
@@ -92,5 +126,8 @@ private:
 
    double mass;           // weight of the M795 projectile. Defaults to 46.7 kg
    double radius;         // radius of M795 projectile. Defaults to 0.077545 m
-   std::list<PositionVelocityTime> flightPath;
+   AmmunitionType ammunition; // whose drag table to use
+   RingBuffer<PositionVelocityTime, FLIGHT_PATH_LENGTH> flightPath;
+   FlightTrack track;     // the whole flight, when recording
+   Ballistics ballistics; // adaptive stepping, carried between frames
 };
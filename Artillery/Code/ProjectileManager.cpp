@@ -0,0 +1,223 @@
+/***********************************************************************
+ * Source File:
+ *    PROJECTILE MANAGER
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Pooled rounds, stepped and hit-tested together
+ ************************************************************************/
+
+#include "projectileManager.h"
+#include "terrainPyramid.h"
+#include <algorithm>   // for min, max, and swap
+#include <cmath>
+using namespace std;
+
+/***********************************************************************
+ * ENTER BOX
+ * Where the segment from (x0, y0) to (x1, y1) first gets inside the
+ * square of half width half around (cx, cy), as a fraction of the way
+ * along it. Slab test: the overlap of the stretches inside in x and
+ * inside in y.
+ ************************************************************************/
+static bool enterBox(double x0, double y0, double x1, double y1,
+                     double cx, double cy, double half, double& fraction)
+{
+   double u0 = 0.0;
+   double u1 = 1.0;
+
+   const double from[2] = { x0 - cx, y0 - cy };
+   const double delta[2] = { x1 - x0, y1 - y0 };
+   for (int axis = 0; axis < 2; axis++)
+   {
+      if (delta[axis] == 0.0)
+      {
+         if (fabs(from[axis]) > half)
+            return false;
+         continue;
+      }
+      double ua = (-half - from[axis]) / delta[axis];
+      double ub = (half - from[axis]) / delta[axis];
+      if (ua > ub)
+         swap(ua, ub);
+      u0 = max(u0, ua);
+      u1 = min(u1, ub);
+   }
+
+   if (u0 > u1)
+      return false;
+   fraction = u0;
+   return true;
+}
+
+/***********************************************************************
+ * PROJECTILE MANAGER :: FIRE
+ ************************************************************************/
+size_t ProjectileManager::fire(const Position& posHowitzer, double simulationTime,
+                               const Angle& elevation, double muzzleVelocity, int gun,
+                               AmmunitionType ammunition)
+{
+   const AmmunitionSpec& spec = getAmmunition(ammunition);
+   Pool& pool = pools[ammunition];
+
+   size_t round;
+   if (!pool.vacant.empty())
+   {
+      round = pool.vacant.back();
+      pool.vacant.pop_back();
+      pool.rounds.fire(round, posHowitzer, simulationTime, elevation, muzzleVelocity,
+                       spec.mass, spec.radius);
+   }
+   else
+   {
+      round = pool.rounds.fire(posHowitzer, simulationTime, elevation, muzzleVelocity,
+                               spec.mass, spec.radius);
+      pool.lastX.push_back(0.0);
+      pool.lastY.push_back(0.0);
+      pool.guns.push_back(0);
+   }
+
+   pool.lastX[round] = posHowitzer.getMetersX();
+   pool.lastY[round] = posHowitzer.getMetersY();
+   pool.guns[round] = gun;
+   return round;
+}
+
+/***********************************************************************
+ * PROJECTILE MANAGER :: ADVANCE
+ * Remember where everything was so the whole frame can be hit-tested.
+ * The registry picks the compiled step once per pool, not per round.
+ ************************************************************************/
+void ProjectileManager::advance(double simulationTime)
+{
+   for (int type = 0; type < AMMUNITION_TYPES; type++)
+   {
+      Pool& pool = pools[type];
+      if (pool.rounds.getFlying() == 0)
+         continue;
+      copy(pool.rounds.x.begin(), pool.rounds.x.end(), pool.lastX.begin());
+      copy(pool.rounds.y.begin(), pool.rounds.y.end(), pool.lastY.begin());
+      getAmmunition((AmmunitionType)type).advance(pool.rounds, simulationTime);
+   }
+   lastStep = simulationTime;
+}
+
+/***********************************************************************
+ * PROJECTILE MANAGER :: IMPACT
+ * Each round's last step is a segment. It stops at whichever it meets
+ * first: a target box or the terrain. The terrain test only goes down
+ * into the pyramid where the segment dips below it, so a round high in
+ * the air costs one comparison.
+ ************************************************************************/
+const vector <ProjectileImpact>& ProjectileManager::impact(const TerrainPyramid& terrain,
+                                                           const vector <Position>& targets)
+{
+   Position half;
+   half.setPixelsX(TARGET_HALF_PIXELS);
+   const double halfBox = half.getMetersX();
+
+   impacts.clear();
+   for (int type = 0; type < AMMUNITION_TYPES; type++)
+   {
+      Pool& pool = pools[type];
+      BatchProjectile& rounds = pool.rounds;
+      if (rounds.getFlying() == 0)
+         continue;
+
+      for (size_t i = 0; i < rounds.size(); i++)
+      {
+         if (!rounds.isFlying(i))
+            continue;
+
+         const double x0 = pool.lastX[i];
+         const double y0 = pool.lastY[i];
+         const double x1 = rounds.x[i];
+         const double y1 = rounds.y[i];
+
+         ProjectileImpact hit;
+         hit.event = EVENT_NONE;
+         hit.target = -1;
+         double first = 2.0;
+         double fraction;
+
+         if (terrain.firstHit(x0, y0, x1, y1, fraction))
+         {
+            hit.event = EVENT_GROUND;
+            first = fraction;
+         }
+         for (size_t target = 0; target < targets.size(); target++)
+            if (enterBox(x0, y0, x1, y1, targets[target].getMetersX(),
+                         targets[target].getMetersY(), halfBox, fraction) &&
+                fraction <= first)
+            {
+               hit.event = EVENT_TARGET;
+               hit.target = (int)target;
+               first = fraction;
+            }
+
+         if (hit.event == EVENT_NONE)
+            continue;
+
+         hit.round = i;
+         hit.ammunition = (AmmunitionType)type;
+         hit.gun = pool.guns[i];
+         hit.t = rounds.t[i] - (1.0 - first) * lastStep;
+         hit.x = x0 + first * (x1 - x0);
+         hit.y = y0 + first * (y1 - y0);
+         impacts.push_back(hit);
+
+         rounds.retire(i);
+         pool.vacant.push_back(i);
+      }
+   }
+   return impacts;
+}
+
+/***********************************************************************
+ * PROJECTILE MANAGER :: CLEAR
+ ************************************************************************/
+void ProjectileManager::clear()
+{
+   for (Pool& pool : pools)
+   {
+      pool.rounds.clear();
+      pool.lastX.clear();
+      pool.lastY.clear();
+      pool.guns.clear();
+      pool.vacant.clear();
+   }
+   impacts.clear();
+}
+
+/***********************************************************************
+ * PROJECTILE MANAGER :: GET FLYING
+ ************************************************************************/
+size_t ProjectileManager::getFlying() const
+{
+   size_t flying = 0;
+   for (const Pool& pool : pools)
+      flying += pool.rounds.getFlying();
+   return flying;
+}
+
+/***********************************************************************
+ * PROJECTILE MANAGER :: GET CAPACITY
+ ************************************************************************/
+size_t ProjectileManager::getCapacity() const
+{
+   size_t capacity = 0;
+   for (const Pool& pool : pools)
+      capacity += pool.rounds.size();
+   return capacity;
+}
+
+/***********************************************************************
+ * PROJECTILE MANAGER :: DRAW
+ ************************************************************************/
+void ProjectileManager::draw(ogstream& gout) const
+{
+   for (const Pool& pool : pools)
+      for (size_t i = 0; i < pool.rounds.size(); i++)
+         if (pool.rounds.isFlying(i))
+            gout.drawProjectile(pool.rounds.getPosition(i), 0.0);
+}
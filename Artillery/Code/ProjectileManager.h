@@ -0,0 +1,101 @@
+/**********************************************************************
+ * Header File:
+ *    PROJECTILE MANAGER
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Every round a battery has in the air. Rounds live in one pool of
+ *    arrays that is stepped all at once, and a round that lands gives
+ *    its slot to the next one fired, so a sustained salvo reaches a
+ *    steady size instead of growing. After each frame, every round's
+ *    path over that frame is tested against the targets and the
+ *    terrain in one pass, so a frame costs the same per round no matter
+ *    how many are up.
+ *
+ *    Each kind of ammunition has its own pool, stepped by the code
+ *    compiled for that round, so a mixed salvo costs the same per round
+ *    as one of a single kind.
+ ************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "batchProjectile.h"
+#include "ballistics.h"   // for BallisticEvent
+#include "ammunition.h"   // for AmmunitionType
+#include "uiDraw.h"       // for ogstream
+
+class TerrainPyramid;
+
+/**********************************************************************
+ * PROJECTILE IMPACT
+ * A round that came down this frame
+ ************************************************************************/
+struct ProjectileImpact
+{
+   size_t round;            // slot, free again
+   AmmunitionType ammunition; // whose pool the slot is in
+   int gun;                 // which howitzer fired it
+   int target;              // which target, for EVENT_TARGET
+   BallisticEvent event;
+   double t;                // seconds
+   double x;                // meters
+   double y;
+};
+
+/**********************************************************************
+ * PROJECTILE MANAGER
+ * A pool of rounds in flight
+ ************************************************************************/
+class ProjectileManager
+{
+public:
+   ProjectileManager() : lastStep(0.0) {}
+
+   // fire a round, into a free slot if there is one. Returns the slot
+   // in the pool for its ammunition.
+   size_t fire(const Position& posHowitzer, double simulationTime,
+               const Angle& elevation, double muzzleVelocity, int gun = 0,
+               AmmunitionType ammunition = AMMUNITION_M795);
+
+   // step every round in the air
+   void advance(double simulationTime);
+
+   // retire every round that entered a target box or hit the terrain
+   // since the last advance, each at the first thing it met
+   const std::vector <ProjectileImpact>& impact(const TerrainPyramid& terrain,
+                                                const std::vector <Position>& targets);
+
+   // take every round out of the air
+   void clear();
+
+   // getters
+   size_t getFlying() const;
+   size_t getCapacity() const;
+   bool isFlying(size_t round, AmmunitionType ammunition = AMMUNITION_M795) const
+   {
+      return pools[ammunition].rounds.isFlying(round);
+   }
+   Position getPosition(size_t round, AmmunitionType ammunition = AMMUNITION_M795) const
+   {
+      return pools[ammunition].rounds.getPosition(round);
+   }
+
+   // draw every round in the air
+   void draw(ogstream& gout) const;
+
+private:
+   // every round of one kind of ammunition
+   struct Pool
+   {
+      BatchProjectile rounds;
+      std::vector <double> lastX;       // where each round was before the last advance
+      std::vector <double> lastY;
+      std::vector <int> guns;
+      std::vector <size_t> vacant;      // slots of rounds that have landed
+   };
+
+   Pool pools[AMMUNITION_TYPES];
+   std::vector <ProjectileImpact> impacts;
+   double lastStep;                     // seconds in the last advance
+};
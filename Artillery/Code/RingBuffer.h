@@ -0,0 +1,58 @@
+/**********************************************************************
+ * Header File:
+ *    RING BUFFER
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    A fixed number of the most recent items. Adding to a full buffer
+ *    writes over the oldest item, so nothing is ever allocated after
+ *    the buffer is made.
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>   // for size_t
+
+/**********************************************************************
+ * RING BUFFER
+ * The last Capacity items, oldest first
+ ************************************************************************/
+template <class T, size_t Capacity>
+class RingBuffer
+{
+public:
+   RingBuffer() : head(0), count(0) {}
+
+   // add to the end, dropping the oldest if full
+   void push_back(const T& item)
+   {
+      items[(head + count) % Capacity] = item;
+      if (count < Capacity)
+         count++;
+      else
+         head = (head + 1) % Capacity;
+   }
+
+   // forget everything
+   void clear() { head = 0; count = 0; }
+
+   // getters
+   size_t size() const { return count; }
+   bool empty() const { return count == 0; }
+   static size_t capacity() { return Capacity; }
+
+   // 0 is the oldest, size() - 1 the newest
+   const T& operator[](size_t i) const
+   {
+      assert(i < count);
+      return items[(head + i) % Capacity];
+   }
+   const T& front() const { return (*this)[0]; }
+   const T& back() const { return (*this)[count - 1]; }
+
+private:
+   T items[Capacity];
+   size_t head;    // where the oldest item is
+   size_t count;   // how many items are held
+};
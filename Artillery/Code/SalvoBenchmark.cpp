@@ -0,0 +1,115 @@
+/***********************************************************************
+ * Source File:
+ *    SALVO BENCHMARK
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    salvobench: how long the projectile manager takes per round per
+ *    frame of steady fire. It is its own program: build it from this
+ *    file and every source file of the game except the ones with mains
+ *    of their own (main.cpp, artilleryTests.cpp, ballisticDaemon.cpp)
+ *    and the window (simulation.cpp, uiInteract.cpp). Use the
+ *    optimization and -mavx2 -mfma the game is built with, or the times
+ *    are of the scalar loops. With g++:
+ *
+ *       g++ -std=c++17 -O2 -mavx2 -mfma -o salvobench salvoBenchmark.cpp
+ *           <those other source files> -lpthread
+ *
+ *    Each run fires a number of rounds every frame, one frame a second,
+ *    until as many land each frame as are fired. The second half of the
+ *    frames is timed: one advance and one impact test of everything in
+ *    the air.
+ *
+ *    usage: salvobench [rounds per frame ...]
+ ************************************************************************/
+
+#include "projectileManager.h"
+#include "terrainPyramid.h"
+#include "ground.h"
+#include "position.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>   // for atoi
+#include <vector>
+using namespace std;
+
+#define BENCH_FRAMES 400   // frames per run; the second half is timed
+
+double Position::metersFromPixels = 40.0;
+
+/***********************************************************************
+ * RUN
+ * One rate of fire. Rounds go out in a fan so they land all over, from
+ * guns on top of the terrain the rounds are tested against.
+ ************************************************************************/
+static void run(int perFrame, const TerrainPyramid& terrain, const Ground& ground)
+{
+   vector <Position> targets(1, ground.getTarget());
+   ProjectileManager salvo;
+   double seconds = 0.0;
+   double flying = 0.0;
+   size_t hits = 0;
+   size_t impacts = 0;
+   int timed = 0;
+
+   for (int frame = 0; frame < BENCH_FRAMES; frame++)
+   {
+      for (int k = 0; k < perFrame; k++)
+      {
+         Angle elevation;
+         elevation.setRadians(0.3 + 1.0 * k / perFrame);
+         Position gun;
+         gun.setMetersX(2000.0 + k);
+         gun.setMetersY(terrain.height(gun.getMetersX()));
+         salvo.fire(gun, frame, elevation, 827.0, k % 6);
+      }
+
+      auto start = chrono::steady_clock::now();
+      salvo.advance(1.0);
+      const vector <ProjectileImpact>& landed = salvo.impact(terrain, targets);
+      auto end = chrono::steady_clock::now();
+
+      if (frame >= BENCH_FRAMES / 2)
+      {
+         seconds += chrono::duration <double>(end - start).count();
+         flying += salvo.getFlying();
+         timed++;
+      }
+      for (const ProjectileImpact& impact : landed)
+         (impact.event == EVENT_TARGET ? hits : impacts)++;
+   }
+
+   flying /= timed;
+   printf("%6d per frame  %8.0f flying  %8zu capacity  %8.1f us/frame  %6.1f ns/round"
+          "  %zu hits  %zu impacts\n",
+          perFrame, flying, salvo.getCapacity(), 1e6 * seconds / timed,
+          flying > 0.0 ? 1e9 * seconds / timed / flying : 0.0, hits, impacts);
+}
+
+/***********************************************************************
+ * MAIN
+ ************************************************************************/
+int main(int argc, char** argv)
+{
+   Position posUpperRight;
+   posUpperRight.setPixelsX(700.0);
+   posUpperRight.setPixelsY(500.0);
+
+   Position gun;
+   gun.setMetersX(2000.0);
+   Ground ground(posUpperRight);
+   ground.reset(gun);
+   TerrainPyramid terrain;
+   terrain.build(ground, posUpperRight);
+
+   vector <int> rates;
+   for (int i = 1; i < argc; i++)
+      rates.push_back(atoi(argv[i]));
+   if (rates.empty())
+      rates = { 10, 100, 1000 };
+
+   for (int perFrame : rates)
+      if (perFrame > 0)
+         run(perFrame, terrain, ground);
+   return 0;
+}
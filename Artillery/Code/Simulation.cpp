@@ -8,6 +8,62 @@
  ************************************************************************/
 
 #include "simulation.h"  // for SIMULATION
+#include "telemetry.h"   // for TELEMETRY
+#include "firingSolution.h" // for FIRING SOLVER
+
+/**********************************************************
+ * DESTRUCTOR
+ * Stop a coverage sweep still going
+**********************************************************/
+Simulator::~Simulator()
+{
+   coverageCancel = true;
+   if (coverageWorker.joinable())
+      coverageWorker.join();
+}
+
+/**********************************************************
+ * START COVERAGE
+ * The old map is of where the gun was, so it goes now and
+ * the new one is drawn when it is ready, a frame or two
+ * later. The sweep flies against its own copy of the
+ * terrain. A sweep still going is of where the gun was
+ * too, so it is cancelled: only the flights already under
+ * way are waited for, not the rest of the sweep.
+**********************************************************/
+void Simulator::startCoverage()
+{
+   if (coverageWorker.joinable())
+   {
+      coverageCancel = true;
+      coverageWorker.join();
+   }
+   coverageCancel = false;
+   coverageReady = false;
+   coverage = CoverageMap();
+
+   pendingCoverage.setMuzzleVelocity(howitzer.getMuzzleVelocity());
+   pendingTerrain = terrain;
+   Position gun = howitzer.getPosition();
+   coverageWorker = thread([this, gun]()
+   {
+      if (pendingCoverage.compute(gun, pendingTerrain, &coverageCancel))
+         coverageReady = true;
+   });
+}
+
+/**********************************************************
+ * FINISH COVERAGE
+ * Swap in the new map, if it is done
+**********************************************************/
+void Simulator::finishCoverage()
+{
+   if (!coverageReady)
+      return;
+   coverageWorker.join();
+   swap(coverage, pendingCoverage);
+   coverageReady = false;
+}
 
 /**********************************************************
  * DISPLAY
@@ -23,9 +79,18 @@ void Simulator::display()
    // Draw the ground
    ground.draw(gout);
 
+   // Draw where the howitzer can reach, once it is known
+   finishCoverage();
+   coverage.draw(gout);
+
    // Draw the projectile
    projectile.draw(gout);
 
+   // Draw the battery and its rounds
+   for (const Howitzer& gun : battery)
+      gun.draw(gout, 100.0);
+   salvo.draw(gout);
+
    gout = Position(23000, 18000);  // set position of messages
    gout.setf(ios::fixed);          // for double precision
    gout.precision(1);
@@ -88,19 +153,102 @@ void Simulator::update(const Interface* pUI)
    }
 }
 
+/**********************************************************
+ * AIM HOWITZER
+ * The flat solution if there is one, the plunging one if a
+ * hill is in the way, and as far as it goes toward the
+ * target if neither reaches
+**********************************************************/
+void Simulator::aimHowitzer(size_t gun)
+{
+   Position& position = battery[gun].getPosition();
+   position.setMetersY(ground.getElevationMeters(position));
+
+   FiringSolver solver;
+   solver.setAmmunition(batteryAmmunition[gun]);
+   solver.setMuzzleVelocity(battery[gun].getMuzzleVelocity());
+   FiringSolutions solutions = solver.solve(position, ground.getTarget(), ground);
+
+   bool right = ground.getTarget().getMetersX() >= position.getMetersX();
+   double elevation = right ? M_PI_4 : -M_PI_4;
+   if (solutions.low.valid)
+      elevation = solutions.low.elevation;
+   else if (solutions.high.valid)
+      elevation = solutions.high.elevation;
+   battery[gun].setElevation(elevation);
+}
+
+/**********************************************************
+ * SALVO FRAME
+ * The battery's rounds, one second per frame like the
+ * player's round
+**********************************************************/
+void Simulator::salvoFrame()
+{
+   if (battery.empty() && salvo.getFlying() == 0)
+      return;
+
+   salvoTime += 1.0;
+   salvoClock += 1.0;
+   if (salvoInterval > 0.0 && salvoClock >= salvoInterval)
+   {
+      salvoClock -= salvoInterval;
+      for (size_t i = 0; i < battery.size(); i++)
+         salvo.fire(battery[i].getPosition(), salvoTime, battery[i].getElevation(),
+                    battery[i].getMuzzleVelocity(), (int)i, batteryAmmunition[i]);
+   }
+
+   salvo.advance(1.0);
+   for (const ProjectileImpact& impact : salvo.impact(terrain, vector <Position>(1, ground.getTarget())))
+   {
+      TELEMETRY(TELEMETRY_EVENT, impact.event == EVENT_TARGET ? TELEMETRY_HIT : TELEMETRY_IMPACT,
+                (uint32_t)impact.round, impact.t, impact.x, impact.y, 0.0, 0.0);
+   }
+}
+
 /**********************************************************
  * DISPLAY
  * Draw on the screen
 **********************************************************/
 void Simulator::gameplay(const Interface* pUI)
 {
+   salvoFrame();
+
    if (pUI->isSpace() && !projectile.isFlying())
    {
       projectile.fire(howitzer.getPosition(), 0.5, howitzer.getElevation(), howitzer.getMuzzleVelocity());
-      projectile.advance(1.0);
-      
+      if (!adaptive)
+         projectile.advance(1.0);
    }
-   if (projectile.isFlying())
+
+   // adaptive steps stop exactly where the round hits something
+   if (projectile.isFlying() && adaptive)
+   {
+      BallisticEvent event = projectile.advance(1.0, terrain, ground.getTarget());
+
+      // YOU SUNK MY BATTLESHIP
+      if (event == EVENT_TARGET)
+      {
+         TELEMETRY(TELEMETRY_EVENT, TELEMETRY_HIT, 0, projectile.getCurrentTime(),
+                   projectile.getPosition().getMetersX(), projectile.getPosition().getMetersY(),
+                   0.0, 0.0);
+         howitzer.generatePosition(posUpperRight);
+         ground.reset(howitzer.getPosition());
+         terrain.build(ground, posUpperRight);
+         startCoverage();
+         for (size_t i = 0; i < battery.size(); i++)
+            aimHowitzer(i);
+         projectile.reset();
+      }
+      else if (event == EVENT_GROUND)
+      {
+         TELEMETRY(TELEMETRY_EVENT, TELEMETRY_IMPACT, 0, projectile.getCurrentTime(),
+                   projectile.getPosition().getMetersX(), projectile.getPosition().getMetersY(),
+                   0.0, 0.0);
+         projectile.reset();
+      }
+   }
+   else if (projectile.isFlying())
    {
       // YOU SUNK MY BATTLESHIP
       if (projectile.getPosition().getPixelsX() >= ground.getTarget().getPixelsX() - 10.0 &&
@@ -108,17 +256,35 @@ void Simulator::gameplay(const Interface* pUI)
          projectile.getPosition().getPixelsY() >= ground.getTarget().getPixelsY() - 10.0 &&
          projectile.getPosition().getPixelsY() <= ground.getTarget().getPixelsY() + 10.0)
       {
+         TELEMETRY(TELEMETRY_EVENT, TELEMETRY_HIT, 0, projectile.getCurrentTime(),
+                   projectile.getPosition().getMetersX(), projectile.getPosition().getMetersY(),
+                   0.0, 0.0);
          howitzer.generatePosition(posUpperRight);
          ground.reset(howitzer.getPosition());
+         terrain.build(ground, posUpperRight);
+         startCoverage();
+         for (size_t i = 0; i < battery.size(); i++)
+            aimHowitzer(i);
          projectile.reset();
       }
-      if (ground.getElevationMeters(projectile.getPosition()) < projectile.getPosition().getMetersY())
+      else
       {
+         // the whole second of flight against the terrain, not just
+         // where the round ends up
+         Position before = projectile.getPosition();
          projectile.advance(1.0);
+         Position after = projectile.getPosition();
+
+         double fraction;
+         if (terrain.firstHit(before.getMetersX(), before.getMetersY(),
+                              after.getMetersX(), after.getMetersY(), fraction))
+         {
+            TELEMETRY(TELEMETRY_EVENT, TELEMETRY_IMPACT, 0, projectile.getCurrentTime(),
+                      before.getMetersX() + fraction * (after.getMetersX() - before.getMetersX()),
+                      before.getMetersY() + fraction * (after.getMetersY() - before.getMetersY()),
+                      0.0, 0.0);
+            projectile.reset();
+         }
       }
-      else
-      {
-         projectile.reset();
-      } 
    }
 }
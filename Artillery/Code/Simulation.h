@@ -12,6 +12,12 @@
 #include "ground.h"      // for GROUND
 #include "howitzer.h"    // for HOWITZER
 #include "projectile.h"  // for PROJECTILE
+#include "terrainPyramid.h" // for TERRAIN PYRAMID
+#include "projectileManager.h" // for PROJECTILE MANAGER
+#include "coverageMap.h"   // for COVERAGE MAP
+#include <atomic>
+#include <thread>
+#include <vector>
 #include "uiInteract.h"  // for INTERFACE
 
 using namespace std;
@@ -24,12 +30,21 @@ class Simulator
 {
 public:
    Simulator(const Position & posUpperRight) :
-      ground(posUpperRight)
+      ground(posUpperRight),
+      coverageReady(false),
+      coverageCancel(false),
+      adaptive(false),
+      salvoInterval(0.0),
+      salvoClock(0.0),
+      salvoTime(0.0)
    {
       howitzer.generatePosition(posUpperRight);
       ground.reset(howitzer.getPosition());
       this->posUpperRight = posUpperRight;
+      terrain.build(ground, posUpperRight);
+      startCoverage();
    }
+   ~Simulator();
 
    // display stuff on the screen
    void display();
@@ -40,9 +55,51 @@ public:
    // handle gameplay rules
    void gameplay(const Interface* pUI);
 
+   // adaptive steps with exact impacts, or the old one second steps.
+   // Off unless asked for, so the player's round flies as it always has.
+   void setAdaptive(bool adaptive) { this->adaptive = adaptive; }
+
+   // another gun in the battery. It fires with the rest of the battery
+   // every salvoInterval seconds, apart from the player's howitzer. It
+   // stands on the ground where it is put and is aimed at the target,
+   // and again each time the ground changes.
+   void addHowitzer(const Howitzer& gun, AmmunitionType ammunition = AMMUNITION_M795)
+   {
+      battery.push_back(gun);
+      batteryAmmunition.push_back(ammunition);
+      aimHowitzer(battery.size() - 1);
+   }
+   void setSalvoInterval(double salvoInterval) { this->salvoInterval = salvoInterval; }
+   const ProjectileManager& getSalvo() const { return salvo; }
+
 private:
+   // fire, move, and land the battery's rounds for one frame
+   void salvoFrame();
+
+   // stand a gun of the battery on the ground and lay it on the target
+   void aimHowitzer(size_t gun);
+
+   // sweep the coverage map for where the gun is now on a worker, so
+   // no frame waits on it, and take it once it is done
+   void startCoverage();
+   void finishCoverage();
+
    Ground ground;
+   TerrainPyramid terrain;  // the ground, for finding where a round hits it
+   CoverageMap coverage;    // where the howitzer can reach from where it is
+   CoverageMap pendingCoverage;     // being swept on coverageWorker
+   TerrainPyramid pendingTerrain;   // what it is swept over; terrain may be rebuilt meanwhile
+   std::thread coverageWorker;
+   std::atomic <bool> coverageReady; // pendingCoverage is done
+   std::atomic <bool> coverageCancel; // the gun has moved; stop sweeping
    Howitzer howitzer;
    Projectile projectile;
    Position posUpperRight;
+   bool adaptive;           // adaptive steps and exact impact events, off by default
+   std::vector <Howitzer> battery;
+   std::vector <AmmunitionType> batteryAmmunition; // what each gun fires
+   ProjectileManager salvo;  // every round the battery has in the air
+   double salvoInterval;    // seconds between salvos, 0 to hold fire
+   double salvoClock;       // seconds since the last salvo
+   double salvoTime;        // seconds since the battery started
 };
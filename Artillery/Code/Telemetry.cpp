@@ -0,0 +1,137 @@
+/***********************************************************************
+ * Source File:
+ *    TELEMETRY
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Lock-free telemetry ring and its background writer
+ ************************************************************************/
+
+#include "telemetry.h"
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+atomic <int> Telemetry::currentLevel(TELEMETRY_EVENT);
+
+/***********************************************************************
+ * TELEMETRY :: GET INSTANCE
+ ************************************************************************/
+Telemetry& Telemetry::getInstance()
+{
+   static Telemetry telemetry;
+   return telemetry;
+}
+
+/***********************************************************************
+ * TELEMETRY :: OPEN
+ ************************************************************************/
+bool Telemetry::open(const char* filename, bool binary)
+{
+   fout.open(filename, binary ? ios::out | ios::binary : ios::out);
+   this->binary = binary;
+   return !fout.fail();
+}
+
+/***********************************************************************
+ * TELEMETRY :: START
+ * The writer only exists once there is something to write
+ ************************************************************************/
+void Telemetry::start()
+{
+   running = true;
+   writer = thread([this]()
+   {
+      while (running.load(memory_order_acquire))
+      {
+         if (head.load(memory_order_relaxed) == tail.load(memory_order_acquire))
+            this_thread::sleep_for(chrono::microseconds(200));
+         else
+            drain();
+      }
+      drain();
+   });
+}
+
+/***********************************************************************
+ * TELEMETRY :: PUSH
+ * The slot is filled before tail moves past it, so the writer never
+ * sees a half-written record.
+ ************************************************************************/
+void Telemetry::push(TelemetryKind kind, uint32_t count, double t,
+                     double x, double y, double dx, double dy)
+{
+   if (!running.load(memory_order_relaxed))
+      start();
+
+   uint64_t slot = tail.load(memory_order_relaxed);
+   if (slot - head.load(memory_order_acquire) >= TELEMETRY_CAPACITY)
+   {
+      dropped.fetch_add(1, memory_order_relaxed);
+      return;
+   }
+
+   TelemetryRecord& record = ring[slot & (TELEMETRY_CAPACITY - 1)];
+   record.kind = kind;
+   record.count = count;
+   record.t = t;
+   record.x = x;
+   record.y = y;
+   record.dx = dx;
+   record.dy = dy;
+   tail.store(slot + 1, memory_order_release);
+}
+
+/***********************************************************************
+ * TELEMETRY :: DRAIN
+ * Write out everything queued, flushing once at the end
+ ************************************************************************/
+void Telemetry::drain()
+{
+   uint64_t first = head.load(memory_order_relaxed);
+   uint64_t last = tail.load(memory_order_acquire);
+   for (uint64_t slot = first; slot < last; slot++)
+      write(ring[slot & (TELEMETRY_CAPACITY - 1)]);
+   head.store(last, memory_order_release);
+
+   if (fout.is_open())
+      fout.flush();
+   else
+      cout.flush();
+}
+
+/***********************************************************************
+ * TELEMETRY :: WRITE
+ ************************************************************************/
+void Telemetry::write(const TelemetryRecord& record)
+{
+   if (binary)
+   {
+      fout.write((const char*)&record, sizeof(record));
+      return;
+   }
+
+   static const char* names[] = { "fire", "advance", "impact", "hit" };
+   ostream& out = fout.is_open() ? (ostream&)fout : cout;
+   out << names[record.kind] << ' '
+       << record.count << ' '
+       << record.t << ' '
+       << record.x << ' '
+       << record.y << ' '
+       << record.dx << ' '
+       << record.dy << '\n';
+}
+
+/***********************************************************************
+ * TELEMETRY :: STOP
+ ************************************************************************/
+void Telemetry::stop()
+{
+   if (!writer.joinable())
+      return;
+
+   running = false;
+   writer.join();
+   if (fout.is_open())
+      fout.close();
+}
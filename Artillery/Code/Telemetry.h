@@ -0,0 +1,129 @@
+/**********************************************************************
+ * Header File:
+ *    TELEMETRY
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    What the simulation is doing, without slowing it down. The
+ *    simulation drops fixed-size records into a lock-free ring and
+ *    moves on; a background thread turns them into text (or raw
+ *    records) and writes them out. Build with NO_TELEMETRY defined and
+ *    every TELEMETRY() call compiles to nothing.
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+
+#define TELEMETRY_CAPACITY 65536  // records in the ring, a power of two
+
+/**********************************************************************
+ * TELEMETRY LEVEL
+ * How much to record. Each level includes the ones before it.
+ ************************************************************************/
+enum TelemetryLevel
+{
+   TELEMETRY_OFF,      // nothing
+   TELEMETRY_EVENT,    // shots fired and where they land
+   TELEMETRY_STEP      // every step of every flight
+};
+
+/**********************************************************************
+ * TELEMETRY KIND
+ * What one record is about
+ ************************************************************************/
+enum TelemetryKind
+{
+   TELEMETRY_FIRE,
+   TELEMETRY_ADVANCE,
+   TELEMETRY_IMPACT,
+   TELEMETRY_HIT
+};
+
+/**********************************************************************
+ * TELEMETRY RECORD
+ * One fixed-size entry, written as-is in binary mode
+ ************************************************************************/
+struct TelemetryRecord
+{
+   uint32_t kind;     // TelemetryKind
+   uint32_t count;    // what it means depends on the kind
+   double t;          // seconds
+   double x;          // meters
+   double y;
+   double dx;         // meters/second
+   double dy;
+};
+
+/**********************************************************************
+ * TELEMETRY
+ * A single-producer, single-consumer ring and the thread that empties
+ * it. Only the simulation thread may push.
+ ************************************************************************/
+class Telemetry
+{
+public:
+   // the one telemetry channel
+   static Telemetry& getInstance();
+
+   // cheap enough to check on every step
+   static bool isEnabled(TelemetryLevel level)
+   {
+      return level <= currentLevel.load(std::memory_order_relaxed);
+   }
+   static void setLevel(TelemetryLevel level) { currentLevel.store(level); }
+
+   // write to a file instead of the console. Binary writes the records
+   // exactly as they are. Call before the first record.
+   bool open(const char* filename, bool binary = false);
+
+   // queue a record. Never blocks: if the ring is full the record is dropped.
+   void push(TelemetryKind kind, uint32_t count, double t,
+             double x, double y, double dx, double dy);
+
+   // records lost because the writer fell behind
+   uint64_t getDropped() const { return dropped.load(); }
+
+   // write everything queued so far and stop the writer
+   void stop();
+
+   ~Telemetry() { stop(); }
+
+private:
+   Telemetry() : head(0), tail(0), dropped(0), running(false), binary(false) {}
+   Telemetry(const Telemetry&) = delete;
+   Telemetry& operator=(const Telemetry&) = delete;
+
+   void start();
+   void drain();
+   void write(const TelemetryRecord& record);
+
+   static std::atomic <int> currentLevel;
+
+   TelemetryRecord ring[TELEMETRY_CAPACITY];
+   alignas(64) std::atomic <uint64_t> head;     // next record to write out
+   alignas(64) std::atomic <uint64_t> tail;     // next free slot
+   std::atomic <uint64_t> dropped;
+   std::atomic <bool> running;
+   std::thread writer;
+   std::ofstream fout;
+   bool binary;
+};
+
+/**********************************************************************
+ * TELEMETRY
+ * Record something if the level is high enough
+ ************************************************************************/
+#ifdef NO_TELEMETRY
+#define TELEMETRY(level, kind, count, t, x, y, dx, dy) ((void)0)
+#else
+#define TELEMETRY(level, kind, count, t, x, y, dx, dy)                     \
+   do                                                                      \
+   {                                                                       \
+      if (Telemetry::isEnabled(level))                                     \
+         Telemetry::getInstance().push(kind, count, t, x, y, dx, dy);      \
+   } while (false)
+#endif
@@ -0,0 +1,198 @@
+/***********************************************************************
+ * Source File:
+ *    TERRAIN PYRAMID
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Max-height levels over the ground and segment intersection
+ ************************************************************************/
+
+#include "terrainPyramid.h"
+#include "ground.h"
+#include <algorithm>   // for min and max
+#include <cmath>
+using namespace std;
+
+/***********************************************************************
+ * TERRAIN PYRAMID :: BUILD
+ * Each level is half the width of the one below it, rounded up. An odd
+ * node out at the right end is carried up as it is.
+ ************************************************************************/
+void TerrainPyramid::build(const Ground& ground, const Position& posUpperRight)
+{
+   Position pixel;
+   pixel.setPixelsX(1.0);
+   columnWidth = pixel.getMetersX();
+   columns = (size_t)max(1.0, ceil(posUpperRight.getPixelsX()));
+
+   Position pos;
+   levels.assign(1, vector <double>(columns));
+   for (size_t i = 0; i < columns; i++)
+   {
+      pos.setMetersX((i + 0.5) * columnWidth);
+      levels[0][i] = ground.getElevationMeters(pos);
+   }
+
+   pos.setMetersX(-0.5 * columnWidth);
+   left = ground.getElevationMeters(pos);
+   pos.setMetersX((columns + 0.5) * columnWidth);
+   right = ground.getElevationMeters(pos);
+
+   while (levels.back().size() > 1)
+   {
+      const vector <double>& below = levels.back();
+      vector <double> above((below.size() + 1) / 2);
+      for (size_t i = 0; i < above.size(); i++)
+         above[i] = 2 * i + 1 < below.size() ? max(below[2 * i], below[2 * i + 1]) : below[2 * i];
+      levels.push_back(above);
+   }
+}
+
+/***********************************************************************
+ * TERRAIN PYRAMID :: HEIGHT
+ ************************************************************************/
+double TerrainPyramid::height(double x) const
+{
+   if (x < 0.0)
+      return left;
+   size_t column = (size_t)(x / columnWidth);
+   return column < columns ? levels[0][column] : right;
+}
+
+/***********************************************************************
+ * TERRAIN PYRAMID :: MAX HEIGHT
+ * Climb from both ends toward each other, taking whole nodes where the
+ * range covers them
+ ************************************************************************/
+double TerrainPyramid::maxHeight(double x0, double x1) const
+{
+   if (x0 > x1)
+      swap(x0, x1);
+
+   double highest = -HUGE_VAL;
+   if (x0 < 0.0)
+      highest = left;
+   if (x1 >= columns * columnWidth)
+      highest = max(highest, right);
+
+   double first = max(0.0, floor(x0 / columnWidth));
+   double last = min((double)columns - 1.0, floor(x1 / columnWidth));
+   if (levels.empty() || first > last)
+      return highest;
+
+   size_t lo = (size_t)first;
+   size_t hi = (size_t)last + 1;   // one past
+   for (size_t level = 0; lo < hi; level++)
+   {
+      if (lo & 1)
+         highest = max(highest, levels[level][lo++]);
+      if (hi & 1)
+         highest = max(highest, levels[level][--hi]);
+      lo /= 2;
+      hi /= 2;
+   }
+   return highest;
+}
+
+/***********************************************************************
+ * TERRAIN PYRAMID :: HIT FLAT
+ * The first point of the segment, within xa to xb, that is at or below
+ * h. Coming in below h means hitting the side of the column, but a
+ * segment that starts right on the ground and climbs away from it, as a
+ * round leaving the muzzle does, has not hit anything.
+ ************************************************************************/
+bool TerrainPyramid::hitFlat(double xa, double xb, double h,
+                             double x0, double y0, double x1, double y1, double& fraction)
+{
+   // the part of the segment over this stretch
+   double u0 = 0.0;
+   double u1 = 1.0;
+   if (x1 != x0)
+   {
+      double ua = (xa - x0) / (x1 - x0);
+      double ub = (xb - x0) / (x1 - x0);
+      u0 = max(u0, min(ua, ub));
+      u1 = min(u1, max(ua, ub));
+   }
+   else if (x0 < xa || x0 >= xb)
+      return false;
+   if (u0 > u1)
+      return false;
+
+   double ya = y0 + u0 * (y1 - y0);
+   double yb = y0 + u1 * (y1 - y0);
+   if (u0 > 0.0 ? ya <= h : ya < h)
+   {
+      fraction = u0;
+      return true;
+   }
+   if (yb <= h && yb < ya)
+   {
+      fraction = u0 + (u1 - u0) * (ya - h) / (ya - yb);
+      return true;
+   }
+   return false;
+}
+
+/***********************************************************************
+ * TERRAIN PYRAMID :: FIRST HIT
+ * Skip a node unless the segment gets down to its height somewhere over
+ * it; a leaf is a flat stretch of ground
+ ************************************************************************/
+bool TerrainPyramid::firstHit(int level, size_t node, double x0, double y0,
+                              double x1, double y1, double& fraction) const
+{
+   double xa = (double)(node << level) * columnWidth;
+   double xb = (double)min((node + 1) << level, columns) * columnWidth;
+   double h = levels[level][node];
+
+   if (level == 0)
+      return hitFlat(xa, xb, h, x0, y0, x1, y1, fraction);
+
+   // lowest the segment gets over this node
+   double u0 = 0.0;
+   double u1 = 1.0;
+   if (x1 != x0)
+   {
+      double ua = (xa - x0) / (x1 - x0);
+      double ub = (xb - x0) / (x1 - x0);
+      u0 = max(u0, min(ua, ub));
+      u1 = min(u1, max(ua, ub));
+   }
+   else if (x0 < xa || x0 >= xb)
+      return false;
+   if (u0 > u1 || min(y0 + u0 * (y1 - y0), y0 + u1 * (y1 - y0)) > h)
+      return false;
+
+   size_t child = node * 2;
+   size_t children = levels[level - 1].size();
+   size_t nearest = x1 >= x0 ? child : child + 1;
+   size_t farthest = x1 >= x0 ? child + 1 : child;
+   if (nearest < children && firstHit(level - 1, nearest, x0, y0, x1, y1, fraction))
+      return true;
+   return farthest < children && firstHit(level - 1, farthest, x0, y0, x1, y1, fraction);
+}
+
+/***********************************************************************
+ * TERRAIN PYRAMID :: FIRST HIT
+ * Off the left edge, across the world, and off the right edge, in the
+ * order the segment gets to them
+ ************************************************************************/
+bool TerrainPyramid::firstHit(double x0, double y0, double x1, double y1, double& fraction) const
+{
+   const double width = columns * columnWidth;
+   const bool rightward = x1 >= x0;
+
+   if (!rightward && hitFlat(width, HUGE_VAL, right, x0, y0, x1, y1, fraction))
+      return true;
+   if (rightward && hitFlat(-HUGE_VAL, 0.0, left, x0, y0, x1, y1, fraction))
+      return true;
+
+   if (!levels.empty() &&
+       firstHit((int)levels.size() - 1, 0, x0, y0, x1, y1, fraction))
+      return true;
+
+   if (!rightward)
+      return hitFlat(-HUGE_VAL, 0.0, left, x0, y0, x1, y1, fraction);
+   return hitFlat(width, HUGE_VAL, right, x0, y0, x1, y1, fraction);
+}
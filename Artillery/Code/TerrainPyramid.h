@@ -0,0 +1,68 @@
+/**********************************************************************
+ * Header File:
+ *    TERRAIN PYRAMID
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The ground is one height per pixel column. Level 0 of the pyramid
+ *    is those heights; every level above holds the highest of two
+ *    neighbors below it, so one node says how high the terrain gets
+ *    anywhere under it. A segment that stays above a node's height
+ *    cannot touch anything under it, so a search for where a segment
+ *    first meets the ground only goes down into the nodes it dips
+ *    below, nearest first.
+ ************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "position.h"
+
+class Ground;
+
+// forward declaration for the unit test class
+class TestTerrainPyramid;
+
+/**********************************************************************
+ * TERRAIN PYRAMID
+ * Max-height mip levels over the ground
+ ************************************************************************/
+class TerrainPyramid
+{
+public:
+   // Friend the unit test class
+   friend TestTerrainPyramid;
+
+   TerrainPyramid() : columnWidth(1.0), columns(0), left(0.0), right(0.0) {}
+
+   // sample every column of the ground across the world
+   void build(const Ground& ground, const Position& posUpperRight);
+
+   // meters of ground at x, the same as Ground::getElevationMeters
+   double height(double x) const;
+
+   // highest ground anywhere from x0 to x1
+   double maxHeight(double x0, double x1) const;
+
+   // where the segment from (x0, y0) to (x1, y1) first touches the
+   // ground, as a fraction of the way along it. False if it never does.
+   bool firstHit(double x0, double y0, double x1, double y1, double& fraction) const;
+
+   double getColumnWidth() const { return columnWidth; }
+   size_t getColumns() const { return columns; }
+
+private:
+   // search one node, nearest child first
+   bool firstHit(int level, size_t node, double x0, double y0, double x1, double y1,
+                 double& fraction) const;
+
+   // the segment against a flat stretch of ground from xa to xb
+   static bool hitFlat(double xa, double xb, double h,
+                       double x0, double y0, double x1, double y1, double& fraction);
+
+   std::vector <std::vector <double>> levels;   // levels[0] is the ground
+   double columnWidth;   // meters
+   size_t columns;
+   double left;          // the ground off the left edge of the world
+   double right;         // and off the right
+};
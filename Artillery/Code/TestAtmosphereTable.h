@@ -0,0 +1,111 @@
+/***********************************************************************
+ * Header File:
+ *    Test Atmosphere Table
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The constant-time lookups against the searching versions in
+ *    physics.h, which keep their own copy of the published tables
+ ************************************************************************/
+
+#pragma once
+
+#include "testSuite.h"
+#include "atmosphereTable.h"
+#include "physics.h"
+#include <cmath>
+#include <vector>
+
+#define ATMOSPHERE_TOLERANCE 1e-9   // relative, lookup against search
+#define ATMOSPHERE_SAMPLES   10000  // per table, evenly over its range
+
+/************************************
+ * TEST ATMOSPHERE TABLE
+ ************************************/
+class TestAtmosphereTable : public TestSuite
+{
+public:
+   TestAtmosphereTable() : TestSuite("AtmosphereTable") {}
+
+   void run()
+   {
+      dragMatchesPhysics();
+      densityMatchesPhysics();
+      speedSoundMatchesPhysics();
+      offEitherEnd();
+      notANumber();
+      batchMatchesOne();
+   }
+
+private:
+   // the worst relative difference over [low, high]
+   static double worstError(double (*fast)(double), double (*search)(double),
+                            double low, double high)
+   {
+      double worst = 0.0;
+      for (int i = 0; i <= ATMOSPHERE_SAMPLES; i++)
+      {
+         double x = low + (high - low) * i / ATMOSPHERE_SAMPLES;
+         double expected = search(x);
+         double error = fabs(fast(x) - expected) / fabs(expected);
+         worst = error > worst || std::isnan(error) ? error : worst;
+      }
+      return worst;
+   }
+
+   void dragMatchesPhysics()
+   {
+      checkClose(worstError(dragFromMachFast, dragFromMach, 0.3, 5.0), 0.0,
+                 ATMOSPHERE_TOLERANCE, "drag from Mach 0.3 to 5");
+   }
+
+   void densityMatchesPhysics()
+   {
+      checkClose(worstError(densityFromAltitudeFast, densityFromAltitude, 0.0, 80000.0), 0.0,
+                 ATMOSPHERE_TOLERANCE, "density from 0 to 80 km");
+   }
+
+   void speedSoundMatchesPhysics()
+   {
+      checkClose(worstError(speedSoundFromAltitudeFast, speedSoundFromAltitude, 0.0, 80000.0), 0.0,
+                 ATMOSPHERE_TOLERANCE, "speed of sound from 0 to 80 km");
+   }
+
+   // past either end the lookup holds the end value
+   void offEitherEnd()
+   {
+      check(dragFromMachFast(0.1) == dragFromMachFast(0.3), "drag below Mach 0.3");
+      check(dragFromMachFast(9.0) == dragFromMachFast(5.0), "drag above Mach 5");
+      check(densityFromAltitudeFast(-500.0) == densityFromAltitudeFast(0.0), "density below sea level");
+      check(densityFromAltitudeFast(90000.0) == densityFromAltitudeFast(80000.0), "density above 80 km");
+      check(dragTable.slope(9.0) == 0.0, "no slope past the end");
+   }
+
+   // NaN gets the first value from both the one-at-a-time and the
+   // batch lookup, and never indexes outside the table
+   void notANumber()
+   {
+      double one = dragTable(NAN);
+      double x[4] = { NAN, NAN, NAN, NAN };
+      double batch[4];
+      dragTable(x, batch, 4);
+      check(one == dragFromMachFast(0.3), "NaN gets the first value");
+      check(batch[0] == one && batch[3] == one, "batch lookup agrees on NaN");
+      check(dragTable.slope(NAN) == 0.0, "no slope at NaN");
+   }
+
+   // the batch lookup gives exactly what one lookup at a time does
+   void batchMatchesOne()
+   {
+      std::vector <double> mach(1001);
+      std::vector <double> drag(mach.size());
+      for (size_t i = 0; i < mach.size(); i++)
+         mach[i] = 6.0 * i / (mach.size() - 1);
+      dragTable(mach.data(), drag.data(), mach.size());
+
+      bool same = true;
+      for (size_t i = 0; i < mach.size(); i++)
+         same = same && drag[i] == dragTable(mach[i]);
+      check(same, "batch lookup matches one at a time");
+   }
+};
@@ -0,0 +1,177 @@
+/***********************************************************************
+ * Header File:
+ *    Test Ballistics
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Where the adaptive steps say a round comes down, against a
+ *    reference flown with the game's own step made very small, and
+ *    against the one second steps the game used before
+ ************************************************************************/
+
+#pragma once
+
+#include "testSuite.h"
+#include "ballistics.h"
+#include "projectile.h"
+#include "terrainPyramid.h"
+#include "ground.h"
+#include <algorithm>
+#include <cmath>
+
+#define BALLISTICS_IMPACT_TOLERANCE 1.0     // m, adaptive impact against the reference
+#define BALLISTICS_EVENT_TOLERANCE  1e-3    // m, how near the ground or box it stops
+#define BALLISTICS_REFERENCE_STEP   2.5e-4  // s, the reference's step, and twice it
+#define BALLISTICS_VELOCITY         827.0   // m/s
+
+/************************************
+ * TEST BALLISTICS
+ ************************************/
+class TestBallistics : public TestSuite
+{
+public:
+   TestBallistics() : TestSuite("Ballistics") {}
+
+   void run()
+   {
+      impactMatchesReference(0.4);
+      impactMatchesReference(M_PI / 4.0);
+      impactMatchesReference(1.2);
+      terrainMatchesReference();
+      targetBoxEdge();
+   }
+
+private:
+   // a round leaving the origin at an elevation from vertical
+   static BallisticState launch(double elevation, double y = 0.0)
+   {
+      BallisticState state = { 0.0, 0.0, y,
+                               BALLISTICS_VELOCITY * sin(elevation),
+                               BALLISTICS_VELOCITY * cos(elevation) };
+      return state;
+   }
+
+   static void step(BallisticState& state, double h)
+   {
+      Projectile::step(state, h, getAmmunition(AMMUNITION_M795),
+                       DEFAULT_PROJECTILE_WEIGHT, DEFAULT_PROJECTILE_RADIUS);
+   }
+
+   // down range where Projectile::step with steps of h comes back to
+   // its launch altitude, between the last two samples
+   static double fixedImpact(double elevation, double h)
+   {
+      BallisticState state = launch(elevation);
+      BallisticState last = state;
+      do
+      {
+         last = state;
+         step(state, h);
+      }
+      while (state.y >= 0.0);
+      return last.x + (state.x - last.x) * last.y / (last.y - state.y);
+   }
+
+   // the same with the step error taken out: it halves with the step
+   static double referenceImpact(double elevation)
+   {
+      return 2.0 * fixedImpact(elevation, BALLISTICS_REFERENCE_STEP) -
+                   fixedImpact(elevation, 2.0 * BALLISTICS_REFERENCE_STEP);
+   }
+
+   // the one second frames the game flew before adaptive steps
+   static double oneSecondImpact(double elevation)
+   {
+      BallisticState state = launch(elevation);
+      while (state.t == 0.0 || state.y >= 0.0)
+         step(state, 1.0);
+      return state.x;
+   }
+
+   void impactMatchesReference(double elevation)
+   {
+      Ballistics ballistics;
+      ballistics.setAmmunition(getAmmunition(AMMUNITION_M795));
+      ballistics.reset();
+      BallisticState state = launch(elevation);
+      BallisticEvent event = EVENT_NONE;
+      for (int frame = 0; frame < 300 && event == EVENT_NONE; frame++)
+         event = ballistics.advance(state, 1.0, 0.0);
+
+      double reference = referenceImpact(elevation);
+      check(event == EVENT_GROUND, "comes down on level ground");
+      checkClose(state.y, 0.0, BALLISTICS_EVENT_TOLERANCE, "stops at the ground");
+      checkClose(state.x, reference, BALLISTICS_IMPACT_TOLERANCE, "impact against the reference");
+      check(fabs(state.x - reference) * 100.0 < fabs(oneSecondImpact(elevation) - reference),
+            "a hundred times closer than one second steps");
+   }
+
+   // over hills, the reference is the first fine sample under the
+   // terrain, which is within one reference step of where it went in
+   void terrainMatchesReference()
+   {
+      Position posUpperRight;
+      posUpperRight.setPixelsX(700.0);
+      posUpperRight.setPixelsY(500.0);
+      Position howitzer;
+      howitzer.setMetersX(2000.0);
+      Ground ground(posUpperRight);
+      ground.reset(howitzer);
+      TerrainPyramid terrain;
+      terrain.build(ground, posUpperRight);
+
+      const double elevation = 0.3;
+      const double start = terrain.maxHeight(howitzer.getMetersX() - 40.0,
+                                             howitzer.getMetersX() + 40.0);
+      BallisticState reference = launch(elevation, start);
+      reference.x = howitzer.getMetersX();
+      BallisticState state = reference;
+      while (reference.t == 0.0 || reference.y > terrain.height(reference.x))
+         step(reference, BALLISTICS_REFERENCE_STEP);
+
+      Ballistics ballistics;
+      ballistics.setAmmunition(getAmmunition(AMMUNITION_M795));
+      ballistics.reset();
+      BallisticEvent event = EVENT_NONE;
+      for (int frame = 0; frame < 300 && event == EVENT_NONE; frame++)
+         event = ballistics.advance(state, 1.0, terrain);
+
+      check(event == EVENT_GROUND, "comes down in the hills");
+      checkClose(state.x, reference.x, BALLISTICS_IMPACT_TOLERANCE, "hill impact against the reference");
+      check(state.y <= terrain.height(state.x) + BALLISTICS_EVENT_TOLERANCE, "stops in the terrain");
+   }
+
+   // a box the round flies through, twenty seconds out: it stops on
+   // the edge it comes in by
+   void targetBoxEdge()
+   {
+      Position posUpperRight;
+      posUpperRight.setPixelsX(700.0);
+      posUpperRight.setPixelsY(500.0);
+      Ground ground(posUpperRight);
+      TerrainPyramid terrain;
+      terrain.build(ground, posUpperRight);
+
+      const double start = terrain.maxHeight(0.0, 40.0);
+      BallisticState reference = launch(M_PI / 4.0, start);
+      while (reference.t < 20.0)
+         step(reference, BALLISTICS_REFERENCE_STEP);
+      Position target;
+      target.setMetersX(reference.x);
+      target.setMetersY(reference.y);
+      const double half = TARGET_HALF_PIXELS * Position::metersFromPixels;
+
+      Ballistics ballistics;
+      ballistics.setAmmunition(getAmmunition(AMMUNITION_M795));
+      ballistics.reset();
+      BallisticState state = launch(M_PI / 4.0, start);
+      BallisticEvent event = EVENT_NONE;
+      for (int frame = 0; frame < 300 && event == EVENT_NONE; frame++)
+         event = ballistics.advance(state, 1.0, terrain, target);
+
+      double left = fabs(state.x - (target.getMetersX() - half));
+      double bottom = fabs(state.y - (target.getMetersY() - half));
+      check(event == EVENT_TARGET, "flies into the target box");
+      checkClose(std::min(left, bottom), 0.0, BALLISTICS_EVENT_TOLERANCE, "stops on the box edge");
+   }
+};
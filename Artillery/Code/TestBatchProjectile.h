@@ -0,0 +1,141 @@
+/***********************************************************************
+ * Header File:
+ *    Test Batch Projectile
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The batch against Projectile::advance, one projectile per round,
+ *    step for step until every round is back at its launch altitude
+ ************************************************************************/
+
+#pragma once
+
+#include "testSuite.h"
+#include "batchProjectile.h"
+#include "projectile.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define BATCH_TOLERANCE  1e-9   // m and m/s, over the whole flight
+#define BATCH_TIME_STEP  0.5    // s, the game's own step
+#define BATCH_VELOCITY   827.0  // m/s
+
+/************************************
+ * TEST BATCH PROJECTILE
+ ************************************/
+class TestBatchProjectile : public TestSuite
+{
+public:
+   TestBatchProjectile() : TestSuite("BatchProjectile") {}
+
+   void run()
+   {
+      eachRoundMatchesProjectile();
+      everyRoundMatchesProjectile();
+      ownMassAndRadius();
+      landedRoundsStayPut();
+   }
+
+private:
+   // the worst difference in position or velocity between each round
+   // of the batch and its own projectile, flown until the projectiles
+   // come back down. Seven rounds, so the last three miss the vector
+   // loop and take the scalar one.
+   template <class Advance>
+   static double worstError(const std::vector <double>& mass,
+                            const std::vector <double>& radius, Advance advance)
+   {
+      Position launch;
+      launch.setMetersX(0.0);
+      launch.setMetersY(0.0);
+
+      BatchProjectile batch;
+      std::vector <Projectile> single(mass.size());
+      for (size_t i = 0; i < mass.size(); i++)
+      {
+         Angle elevation;
+         elevation.setRadians(0.2 + 0.18 * i);
+         batch.fire(launch, 0.0, elevation, BATCH_VELOCITY, mass[i], radius[i]);
+         single[i].fire(launch, 0.0, elevation, BATCH_VELOCITY);
+         single[i].setMass(mass[i]);
+         single[i].setRadius(radius[i]);
+      }
+
+      double worst = 0.0;
+      while (batch.getFlying() > 0)
+      {
+         advance(batch);
+         for (size_t i = 0; i < single.size(); i++)
+         {
+            if (!batch.isFlying(i))
+               continue;
+            single[i].advance(BATCH_TIME_STEP);
+            Position pos = single[i].getPosition();
+            double speed = sqrt(batch.dx[i] * batch.dx[i] + batch.dy[i] * batch.dy[i]);
+            worst = std::max(worst, fabs(batch.x[i] - pos.getMetersX()));
+            worst = std::max(worst, fabs(batch.y[i] - pos.getMetersY()));
+            worst = std::max(worst, fabs(speed - single[i].getSpeed()));
+            worst = std::max(worst, fabs(batch.t[i] - single[i].getCurrentTime()));
+         }
+         batch.land(0.0);
+      }
+      return worst;
+   }
+
+   static void advanceEach(BatchProjectile& batch) { batch.advance(BATCH_TIME_STEP); }
+   static void advanceEvery(BatchProjectile& batch) { batch.advance<M795>(BATCH_TIME_STEP); }
+
+   void eachRoundMatchesProjectile()
+   {
+      std::vector <double> mass(7, DEFAULT_PROJECTILE_WEIGHT);
+      std::vector <double> radius(7, DEFAULT_PROJECTILE_RADIUS);
+      checkClose(worstError(mass, radius, advanceEach), 0.0, BATCH_TOLERANCE,
+                 "advance with each round's mass and radius");
+   }
+
+   void everyRoundMatchesProjectile()
+   {
+      std::vector <double> mass(7, DEFAULT_PROJECTILE_WEIGHT);
+      std::vector <double> radius(7, DEFAULT_PROJECTILE_RADIUS);
+      checkClose(worstError(mass, radius, advanceEvery), 0.0, BATCH_TOLERANCE,
+                 "advance<M795>");
+   }
+
+   // rounds lighter and wider than the M795, each different, so a lane
+   // reading its neighbour's mass would show
+   void ownMassAndRadius()
+   {
+      std::vector <double> mass;
+      std::vector <double> radius;
+      for (int i = 0; i < 7; i++)
+      {
+         mass.push_back(DEFAULT_PROJECTILE_WEIGHT * (0.5 + 0.1 * i));
+         radius.push_back(DEFAULT_PROJECTILE_RADIUS * (1.3 - 0.05 * i));
+      }
+      checkClose(worstError(mass, radius, advanceEach), 0.0, BATCH_TOLERANCE,
+                 "advance with mixed mass and radius");
+   }
+
+   // a retired round keeps its position, velocity, and time
+   void landedRoundsStayPut()
+   {
+      Position launch;
+      Angle elevation;
+      elevation.setRadians(M_PI / 4.0);
+      BatchProjectile batch;
+      for (int i = 0; i < 5; i++)
+         batch.fire(launch, 0.0, elevation, BATCH_VELOCITY);
+      batch.advance(BATCH_TIME_STEP);
+      batch.retire(1);
+      batch.retire(4);
+
+      double x = batch.x[1];
+      double dy = batch.dy[4];
+      double t = batch.t[1];
+      batch.advance(BATCH_TIME_STEP);
+      check(batch.x[1] == x && batch.t[1] == t, "vector lane stays where it landed");
+      check(batch.dy[4] == dy, "scalar round stays where it landed");
+      check(batch.getFlying() == 3, "three still flying");
+   }
+};
@@ -0,0 +1,62 @@
+/***********************************************************************
+ * Header File:
+ *    Test Suite
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    What every unit test suite shares. Checks are counted and reported
+ *    instead of asserted, so they still run when NDEBUG is defined.
+ ************************************************************************/
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+/************************************
+ * TEST SUITE
+ * The test cases for one class
+ ************************************/
+class TestSuite
+{
+public:
+   TestSuite(const char* name) : name(name), passed(0), failed(0) {}
+   virtual ~TestSuite() {}
+
+   // run every test case
+   virtual void run() = 0;
+
+   // one line for the suite; returns how many checks failed
+   int report() const
+   {
+      printf("%-20s %4d passed %4d failed\n", name, passed, failed);
+      return failed;
+   }
+
+protected:
+   // a check that must hold
+   void check(bool condition, const char* what)
+   {
+      if (condition)
+         passed++;
+      else
+      {
+         failed++;
+         printf("   FAILED %s: %s\n", name, what);
+      }
+   }
+
+   // a value within tolerance of what was expected
+   void checkClose(double actual, double expected, double tolerance, const char* what)
+   {
+      bool close = fabs(actual - expected) <= tolerance;
+      if (!close)
+         printf("   %s: %g, expected %g within %g\n", what, actual, expected, tolerance);
+      check(close, what);
+   }
+
+private:
+   const char* name;
+   int passed;
+   int failed;
+};
@@ -0,0 +1,148 @@
+/***********************************************************************
+ * Header File:
+ *    Test Terrain Pyramid
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The pyramid against the plain way: every column in the order the
+ *    segment gets to it, stopping at the first one it hits
+ ************************************************************************/
+
+#pragma once
+
+#include "testSuite.h"
+#include "terrainPyramid.h"
+#include "ground.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#define PYRAMID_SEGMENTS  100000  // random segments across the world
+#define PYRAMID_TOLERANCE 1e-12   // of the way along the segment
+
+/************************************
+ * TEST TERRAIN PYRAMID
+ ************************************/
+class TestTerrainPyramid : public TestSuite
+{
+public:
+   TestTerrainPyramid() : TestSuite("TerrainPyramid") {}
+
+   void run()
+   {
+      Position posUpperRight;
+      posUpperRight.setPixelsX(700.0);
+      posUpperRight.setPixelsY(500.0);
+      Ground ground(posUpperRight);
+      terrain.build(ground, posUpperRight);
+
+      firstHitMatchesScan();
+      maxHeightMatchesScan();
+      leavingTheMuzzle();
+   }
+
+private:
+   // where the segment first touches a column, one column at a time
+   bool scanHit(double x0, double y0, double x1, double y1, double& fraction) const
+   {
+      const double w = terrain.columnWidth;
+      const double width = terrain.columns * w;
+      const size_t n = terrain.columns;
+      if (x1 >= x0)
+      {
+         if (TerrainPyramid::hitFlat(-HUGE_VAL, 0.0, terrain.left, x0, y0, x1, y1, fraction))
+            return true;
+         for (size_t i = 0; i < n; i++)
+            if (TerrainPyramid::hitFlat(i * w, (i + 1) * w, terrain.levels[0][i],
+                                        x0, y0, x1, y1, fraction))
+               return true;
+         return TerrainPyramid::hitFlat(width, HUGE_VAL, terrain.right, x0, y0, x1, y1, fraction);
+      }
+
+      if (TerrainPyramid::hitFlat(width, HUGE_VAL, terrain.right, x0, y0, x1, y1, fraction))
+         return true;
+      for (size_t i = n; i-- > 0; )
+         if (TerrainPyramid::hitFlat(i * w, (i + 1) * w, terrain.levels[0][i],
+                                     x0, y0, x1, y1, fraction))
+            return true;
+      return TerrainPyramid::hitFlat(-HUGE_VAL, 0.0, terrain.left, x0, y0, x1, y1, fraction);
+   }
+
+   // segments of every length and direction, level and vertical ones
+   // included, from above the hills down into them
+   void firstHitMatchesScan()
+   {
+      const double width = terrain.columns * terrain.columnWidth;
+      std::mt19937_64 generator(43);
+      std::uniform_real_distribution <double> across(-2000.0, width + 2000.0);
+      std::uniform_real_distribution <double> up(0.0, 1200.0);
+      std::uniform_real_distribution <double> length(0.0, 3000.0);
+
+      int agree = 0;
+      int hits = 0;
+      double worst = 0.0;
+      for (int i = 0; i < PYRAMID_SEGMENTS; i++)
+      {
+         double x0 = across(generator);
+         double y0 = up(generator);
+         double x1 = x0 + (i % 2 ? 1.0 : -1.0) * length(generator);
+         double y1 = i % 3 ? up(generator) : y0;
+         if (i % 101 == 0)
+            x1 = x0;
+
+         double fast = NAN;
+         double slow = NAN;
+         bool hit = terrain.firstHit(x0, y0, x1, y1, fast);
+         if (hit == scanHit(x0, y0, x1, y1, slow))
+            agree++;
+         if (hit)
+         {
+            hits++;
+            worst = std::max(worst, fabs(fast - slow));
+         }
+      }
+      check(agree == PYRAMID_SEGMENTS, "hits the same segments as the scan");
+      check(hits > PYRAMID_SEGMENTS / 10 && hits < PYRAMID_SEGMENTS, "some hit, some miss");
+      checkClose(worst, 0.0, PYRAMID_TOLERANCE, "the same first hit as the scan");
+   }
+
+   void maxHeightMatchesScan()
+   {
+      const double w = terrain.columnWidth;
+      std::mt19937_64 generator(7);
+      std::uniform_int_distribution <size_t> column(0, terrain.columns - 1);
+      int agree = 0;
+      for (int i = 0; i < 1000; i++)
+      {
+         size_t a = column(generator);
+         size_t b = column(generator);
+         double highest = -HUGE_VAL;
+         for (size_t c = std::min(a, b); c <= std::max(a, b); c++)
+            highest = std::max(highest, terrain.levels[0][c]);
+         if (terrain.maxHeight((a + 0.5) * w, (b + 0.5) * w) == highest)
+            agree++;
+      }
+      check(agree == 1000, "highest ground over a range");
+   }
+
+   // a round starting on the ground and climbing away has hit nothing;
+   // one coming in below the top of the next column hits its side
+   void leavingTheMuzzle()
+   {
+      const double w = terrain.columnWidth;
+      double fraction = NAN;
+      double x = 100.5 * w;
+      double h = terrain.height(x);
+      check(!terrain.firstHit(x, h, x + 0.4 * w, h + 1000.0, fraction), "climbing off the ground");
+
+      size_t wall = 0;
+      for (size_t i = 101; i < terrain.columns && !wall; i++)
+         if (terrain.levels[0][i] > terrain.levels[0][i - 1] + 1.0)
+            wall = i;
+      double low = terrain.levels[0][wall - 1] + 0.5;
+      check(terrain.firstHit((wall - 0.5) * w, low, (wall + 0.5) * w, low, fraction) &&
+            fabs(fraction - 0.5) < PYRAMID_TOLERANCE, "into the side of a column");
+   }
+
+   TerrainPyramid terrain;
+};
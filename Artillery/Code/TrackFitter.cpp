@@ -0,0 +1,339 @@
+/***********************************************************************
+ * Source File:
+ *    TRACK FITTER
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Incremental Gauss-Newton fit of a flight to radar points
+ ************************************************************************/
+
+#include "trackFitter.h"
+#include "terrainPyramid.h"
+#include "projectile.h"   // for GRAVITY
+#include <algorithm>      // for max
+#include <cmath>
+using namespace std;
+
+#define TRACK_NOISE        5.0   // meters of radar error, one standard deviation
+#define TRACK_STEP         1.0   // seconds, well under a meter over a whole flight
+#define TRACK_RELINEARIZE  1.0   // meters (or m/s) the fit can move before a full pass
+#define TRACK_ITERATIONS    10   // Gauss-Newton passes at most
+#define TRACK_CONVERGED   1e-4   // meters (or m/s) of change that means done
+#define TRACK_MAX_FLIGHT 600.0   // seconds to look for the ground
+#define TRACK_REFINE        16   // pieces the last step is cut into at the ground
+
+/***********************************************************************
+ * CHOLESKY
+ * A = L L^T for a symmetric positive definite 4x4. False if it is not,
+ * as when the points do not pin down all four unknowns yet.
+ ************************************************************************/
+static bool cholesky(const double a[4][4], double l[4][4])
+{
+   for (int i = 0; i < 4; i++)
+      for (int j = 0; j < 4; j++)
+         l[i][j] = 0.0;
+
+   for (int j = 0; j < 4; j++)
+   {
+      double sum = a[j][j];
+      for (int k = 0; k < j; k++)
+         sum -= l[j][k] * l[j][k];
+      if (!(sum > 0.0))
+         return false;
+      l[j][j] = sqrt(sum);
+      for (int i = j + 1; i < 4; i++)
+      {
+         double s = a[i][j];
+         for (int k = 0; k < j; k++)
+            s -= l[i][k] * l[j][k];
+         l[i][j] = s / l[j][j];
+      }
+   }
+   return true;
+}
+
+/***********************************************************************
+ * CHOLESKY SOLVE
+ * x from L L^T x = b, by substitution forward then back
+ ************************************************************************/
+static void choleskySolve(const double l[4][4], const double b[4], double x[4])
+{
+   double y[4];
+   for (int i = 0; i < 4; i++)
+   {
+      double sum = b[i];
+      for (int k = 0; k < i; k++)
+         sum -= l[i][k] * y[k];
+      y[i] = sum / l[i][i];
+   }
+   for (int i = 3; i >= 0; i--)
+   {
+      double sum = y[i];
+      for (int k = i + 1; k < 4; k++)
+         sum -= l[k][i] * x[k];
+      x[i] = sum / l[i][i];
+   }
+}
+
+/***********************************************************************
+ * TRACK FITTER :: CONSTRUCTOR
+ ************************************************************************/
+TrackFitter::TrackFitter() :
+   noise(TRACK_NOISE),
+   step(TRACK_STEP),
+   origin(),
+   estimate(),
+   normal(),
+   gradient(),
+   covariance(),
+   tip(),
+   solved(false),
+   relinearizations(0)
+{
+}
+
+/***********************************************************************
+ * TRACK FITTER :: RESET
+ ************************************************************************/
+void TrackFitter::reset()
+{
+   points.clear();
+   for (int j = 0; j < 4; j++)
+   {
+      origin[j] = estimate[j] = gradient[j] = 0.0;
+      for (int k = 0; k < 4; k++)
+         normal[j][k] = covariance[j][k] = 0.0;
+   }
+   tip = BasicBallisticState<Dual<4>>();
+   solved = false;
+   relinearizations = 0;
+}
+
+/***********************************************************************
+ * TRACK FITTER :: SET AMMUNITION
+ ************************************************************************/
+void TrackFitter::setAmmunition(AmmunitionType ammunition)
+{
+   ballistics.setAmmunition(getAmmunition(ammunition));
+}
+
+/***********************************************************************
+ * TRACK FITTER :: GET STATE
+ ************************************************************************/
+BallisticState TrackFitter::getState() const
+{
+   BallisticState state = { points.empty() ? 0.0 : points.front().t,
+                            estimate[0], estimate[1], estimate[2], estimate[3] };
+   return state;
+}
+
+/***********************************************************************
+ * TRACK FITTER :: SEED
+ ************************************************************************/
+BasicBallisticState<Dual<4>> TrackFitter::seed(const double state[4]) const
+{
+   BasicBallisticState<Dual<4>> flight;
+   flight.t = points.front().t;
+   flight.x = Dual<4>::input(state[0], 0);
+   flight.y = Dual<4>::input(state[1], 1);
+   flight.dx = Dual<4>::input(state[2], 2);
+   flight.dy = Dual<4>::input(state[3], 3);
+   return flight;
+}
+
+/***********************************************************************
+ * TRACK FITTER :: FLY TO
+ * Whole steps, then whatever is left over to land on t exactly
+ ************************************************************************/
+void TrackFitter::flyTo(BasicBallisticState<Dual<4>>& state, double t) const
+{
+   while (state.t.value < t - 1e-9)
+      ballistics.step(state, min(step, t - state.t.value));
+}
+
+/***********************************************************************
+ * TRACK FITTER :: ACCUMULATE
+ * Each point adds two rows, x and y. The derivatives of the flown
+ * position by the four unknowns are the rows of the Jacobian.
+ ************************************************************************/
+void TrackFitter::accumulate(size_t i)
+{
+   flyTo(tip, points[i].t);
+
+   const Dual<4>* flown[2] = { &tip.x, &tip.y };
+   const double seen[2] = { points[i].x, points[i].y };
+   for (int axis = 0; axis < 2; axis++)
+   {
+      const double* row = flown[axis]->d;
+      double residual = seen[axis] - flown[axis]->value;
+      for (int j = 0; j < 4; j++)
+      {
+         gradient[j] += row[j] * residual;
+         for (int k = 0; k < 4; k++)
+            normal[j][k] += row[j] * row[k];
+      }
+   }
+}
+
+/***********************************************************************
+ * TRACK FITTER :: SOLVE
+ * The rows are linear about origin, so the best fit is origin plus the
+ * least squares step. With every point off by noise, the covariance is
+ * noise^2 (J^T J)^-1. If the points do not pin it down, there is no
+ * fit until more arrive.
+ ************************************************************************/
+void TrackFitter::solve()
+{
+   double l[4][4];
+   solved = cholesky(normal, l);
+   if (!solved)
+      return;
+
+   double delta[4];
+   choleskySolve(l, gradient, delta);
+   for (int j = 0; j < 4; j++)
+      estimate[j] = origin[j] + delta[j];
+
+   for (int j = 0; j < 4; j++)
+   {
+      double unit[4] = { 0.0, 0.0, 0.0, 0.0 };
+      double column[4];
+      unit[j] = 1.0;
+      choleskySolve(l, unit, column);
+      for (int i = 0; i < 4; i++)
+         covariance[i][j] = noise * noise * column[i];
+   }
+}
+
+/***********************************************************************
+ * TRACK FITTER :: RELINEARIZE
+ * Fly every point again from the estimate, and repeat until it stops
+ * moving
+ ************************************************************************/
+void TrackFitter::relinearize()
+{
+   relinearizations++;
+   for (int iteration = 0; iteration < TRACK_ITERATIONS; iteration++)
+   {
+      for (int j = 0; j < 4; j++)
+      {
+         origin[j] = estimate[j];
+         gradient[j] = 0.0;
+         for (int k = 0; k < 4; k++)
+            normal[j][k] = 0.0;
+      }
+
+      tip = seed(origin);
+      for (size_t i = 0; i < points.size(); i++)
+         accumulate(i);
+      solve();
+
+      double moved = 0.0;
+      for (int j = 0; j < 4; j++)
+         moved = max(moved, fabs(estimate[j] - origin[j]));
+      if (moved < TRACK_CONVERGED)
+         break;
+   }
+}
+
+/***********************************************************************
+ * TRACK FITTER :: ADD
+ * Two points fix a first guess: where the first one is, and the
+ * velocity that gets to the second under gravity alone. After that,
+ * each point only extends the flight already flown, unless the fit has
+ * moved too far from where it was flown for the rows to still be good.
+ * The flight only goes forward, so a point at or before the last one
+ * could not be fit and is refused.
+ ************************************************************************/
+bool TrackFitter::add(double t, double x, double y)
+{
+   if (!std::isfinite(t) || !std::isfinite(x) || !std::isfinite(y) ||
+       (!points.empty() && !(t > points.back().t)))
+      return false;
+
+   RadarPoint point = { t, x, y };
+   points.push_back(point);
+   if (points.size() < 2)
+      return false;
+
+   if (points.size() == 2)
+   {
+      const RadarPoint& first = points[0];
+      double dt = t - first.t;
+      estimate[0] = first.x;
+      estimate[1] = first.y;
+      estimate[2] = (x - first.x) / dt;
+      estimate[3] = (y - first.y) / dt - 0.5 * GRAVITY * dt;
+      relinearize();
+      return isValid();
+   }
+
+   accumulate(points.size() - 1);
+   solve();
+
+   double moved = 0.0;
+   for (int j = 0; j < 4; j++)
+      moved = max(moved, fabs(estimate[j] - origin[j]));
+   if (moved > TRACK_RELINEARIZE)
+      relinearize();
+   return isValid();
+}
+
+/***********************************************************************
+ * TRACK FITTER :: GROUND
+ * Fixed steps from the estimate until a step's chord meets the terrain,
+ * then that step again in pieces. The crossing is taken as flat ground
+ * at the height it was found, so where it is moves with the flight:
+ * its derivatives, through the covariance, give its spread.
+ ************************************************************************/
+TrackPoint TrackFitter::ground(const TerrainPyramid& terrain, double direction) const
+{
+   TrackPoint point;
+   if (!isValid())
+      return point;
+
+   BasicBallisticState<Dual<4>> state = seed(estimate);
+   const double start = state.t.value;
+   double h = direction * step;
+   double fraction = 0.0;
+   for (int refine = 0; refine < 2; refine++)
+   {
+      BasicBallisticState<Dual<4>> next = state;
+      while (true)
+      {
+         next = state;
+         ballistics.step(next, h);
+         if (terrain.firstHit(state.x.value, state.y.value, next.x.value, next.y.value, fraction))
+            break;
+         if (fabs(next.t.value - start) > TRACK_MAX_FLIGHT)
+            return point;
+         state = next;
+      }
+      if (refine == 0)
+         h /= TRACK_REFINE;
+      else
+      {
+         // flat ground at the crossing
+         double height = state.y.value + fraction * (next.y.value - state.y.value);
+         Dual<4> u = (state.y - height) / (state.y - next.y);
+         Dual<4> t = state.t + u * (next.t - state.t);
+         Dual<4> x = state.x + u * (next.x - state.x);
+
+         point.valid = true;
+         point.t = t.value;
+         point.x = x.value;
+         point.y = height;
+         double varianceT = 0.0;
+         double varianceX = 0.0;
+         for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 4; j++)
+            {
+               varianceT += t.d[i] * covariance[i][j] * t.d[j];
+               varianceX += x.d[i] * covariance[i][j] * x.d[j];
+            }
+         point.sigmaT = sqrt(max(0.0, varianceT));
+         point.sigmaX = sqrt(max(0.0, varianceX));
+      }
+   }
+   return point;
+}
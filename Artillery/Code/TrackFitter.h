@@ -0,0 +1,124 @@
+/**********************************************************************
+ * Header File:
+ *    TRACK FITTER
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Radar sees a shell for a while in the middle of its flight. Fit
+ *    the state of the shell at the first radar point to every point
+ *    seen since, by Gauss-Newton least squares against the same forces
+ *    the game flies a round with, then fly the fit backward to where it
+ *    was fired and forward to where it will land.
+ *
+ *    Flights are on Dual<4> numbers seeded by the four unknowns, so
+ *    one pass gives every residual along with its row of the Jacobian.
+ *    A new point continues that pass from the last point and adds its
+ *    rows to the normal equations, so it costs a few fixed steps and a
+ *    4x4 solve. Only when the answer has moved far from where the rows
+ *    were taken is the whole track flown again.
+ ************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "ballistics.h"
+#include "ammunition.h"
+
+class TerrainPyramid;
+
+/**********************************************************************
+ * RADAR POINT
+ * One observation of a shell
+ ************************************************************************/
+struct RadarPoint
+{
+   double t;   // seconds
+   double x;   // meters
+   double y;
+};
+
+/**********************************************************************
+ * TRACK POINT
+ * Where the fitted flight meets the ground, and how sure that is
+ ************************************************************************/
+struct TrackPoint
+{
+   TrackPoint() : valid(false), t(0.0), x(0.0), y(0.0), sigmaT(0.0), sigmaX(0.0) {}
+
+   bool valid;      // false if there is no fit, or it never meets the ground
+   double t;        // seconds
+   double x;        // meters
+   double y;
+   double sigmaT;   // one standard deviation, seconds
+   double sigmaX;   // and meters
+};
+
+/**********************************************************************
+ * TRACK FITTER
+ * Launch and impact from radar points
+ ************************************************************************/
+class TrackFitter
+{
+public:
+   TrackFitter();
+
+   // setters
+   void setNoise(double noise) { this->noise = noise; }
+   void setStep(double step) { this->step = step; }
+   void setAmmunition(AmmunitionType ammunition);
+
+   // forget every point and the fit made from them
+   void reset();
+
+   // one more radar point, later than the last. A point that is not
+   // later, or not a number, is refused. True if there is a fit.
+   bool add(double t, double x, double y);
+
+   // getters
+   bool isValid() const { return solved; }
+   size_t getPoints() const { return points.size(); }
+   int getRelinearizations() const { return relinearizations; }
+
+   // the fitted state at the first radar point
+   BallisticState getState() const;
+
+   // its covariance: x, y, dx, and dy in that order
+   double getCovariance(int i, int j) const { return covariance[i][j]; }
+
+   // fly the fit back to where it left the ground, or on to where it
+   // comes down
+   TrackPoint launch(const TerrainPyramid& terrain) const { return ground(terrain, -1.0); }
+   TrackPoint impact(const TerrainPyramid& terrain) const { return ground(terrain, 1.0); }
+
+private:
+   // a flight from the state at the first point, seeded as the inputs
+   BasicBallisticState<Dual<4>> seed(const double state[4]) const;
+
+   // fixed steps up to time t
+   void flyTo(BasicBallisticState<Dual<4>>& state, double t) const;
+
+   // continue the flight to point i and add its rows
+   void accumulate(size_t i);
+
+   // solve the normal equations for the estimate and its covariance
+   void solve();
+
+   // Gauss-Newton from scratch, from the current estimate
+   void relinearize();
+
+   // fly from the estimate toward the ground, forward or backward
+   TrackPoint ground(const TerrainPyramid& terrain, double direction) const;
+
+   std::vector <RadarPoint> points;
+   Ballistics ballistics;           // only its forces and fixed steps
+   double noise;                    // meters, one standard deviation
+   double step;                     // seconds
+   double origin[4];                // where the rows were taken
+   double estimate[4];
+   double normal[4][4];             // sum of J^T J
+   double gradient[4];              // sum of J^T (seen - flown)
+   double covariance[4][4];
+   BasicBallisticState<Dual<4>> tip;  // the flight from origin, at the last point
+   bool solved;                     // the normal equations factored last time
+   int relinearizations;
+};
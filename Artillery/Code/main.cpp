@@ -8,6 +8,7 @@
  ************************************************************************/
 
 #include <cassert>      // for ASSERT
+#include <cstring>      // for STRCMP
 #include "uiInteract.h" // for INTERFACE
 #include "uiDraw.h"     // for RANDOM and DRAW*
 #include "simulation.h" // for SIMULATION
@@ -68,6 +69,34 @@ int main(int argc, char** argv)
    // Initialize the simulation.
    Simulator sim(posUpperRight);
 
+   // --adaptive: fly the player's round with adaptive steps and stop it
+   // exactly where it hits, instead of one second at a time
+   // --battery: more guns beside the player's, firing on their own
+   bool adaptive = false;
+   bool battery = false;
+#ifdef _WIN32
+   adaptive = wcsstr(pCmdLine, L"--adaptive") != NULL;
+   battery = wcsstr(pCmdLine, L"--battery") != NULL;
+#else // !_WIN32
+   for (int i = 1; i < argc; i++)
+   {
+      adaptive = adaptive || strcmp(argv[i], "--adaptive") == 0;
+      battery = battery || strcmp(argv[i], "--battery") == 0;
+   }
+#endif // !_WIN32
+   sim.setAdaptive(adaptive);
+
+   // a battery of three more guns firing together every 15 seconds
+   if (battery)
+   {
+      for (int i = 0; i < 3; i++)
+      {
+         Howitzer gun;
+         gun.generatePosition(posUpperRight);
+         sim.addHowitzer(gun);
+      }
+      sim.setSalvoInterval(15.0);
+   }
 
    // set everything into action
    ui.run(callBack, (void *)&sim);
@@ -0,0 +1,122 @@
+/***********************************************************************
+ * Source File:
+ *    Catalog
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    A flat copy of the satellites in orbit, kept as parallel arrays
+ ************************************************************************/
+
+#include "catalog.h"
+#include "satellite.h"
+#include "shellIndex.h"
+#include <cmath>
+using namespace std;
+
+/************************************
+ * CATALOG :: SNAPSHOT
+ * Copy the state of every satellite in orbit
+ ************************************/
+void Catalog::snapshot(const list <Satellite*>& satellites)
+{
+   x.clear();
+   y.clear();
+   dx.clear();
+   dy.clear();
+   source.clear();
+
+   for (auto satellite : satellites)
+      add(satellite->getPosition(), satellite->getVelocity(), satellite);
+}
+
+/************************************
+ * CATALOG :: SNAPSHOT
+ * Copy the satellites in a range of altitude shells. The index already
+ * knows who is there so nothing else is visited.
+ ************************************/
+void Catalog::snapshot(const ShellIndex& index, double altitudeLow, double altitudeHigh)
+{
+   vector <const Satellite*> objects;
+   index.collect(altitudeLow, altitudeHigh, 0.0, M_PI, objects);
+
+   x.clear();
+   y.clear();
+   dx.clear();
+   dy.clear();
+   source.clear();
+
+   for (auto satellite : objects)
+      add(satellite->getPosition(), satellite->getVelocity(), satellite);
+}
+
+/************************************
+ * CATALOG :: ADD
+ * Add one object to the end of the catalog
+ ************************************/
+void Catalog::add(const Position& pos, const Velocity& vel, const Satellite* source)
+{
+   x.push_back(pos.getMetersX());
+   y.push_back(pos.getMetersY());
+   dx.push_back(vel.getDX());
+   dy.push_back(vel.getDY());
+   this->source.push_back(source);
+}
+
+/************************************
+ * CATALOG :: ADD
+ * Copy the rows [begin, end) of another catalog
+ ************************************/
+void Catalog::add(const Catalog& rhs, size_t begin, size_t end)
+{
+   x.insert(x.end(), rhs.x.begin() + begin, rhs.x.begin() + end);
+   y.insert(y.end(), rhs.y.begin() + begin, rhs.y.begin() + end);
+   dx.insert(dx.end(), rhs.dx.begin() + begin, rhs.dx.begin() + end);
+   dy.insert(dy.end(), rhs.dy.begin() + begin, rhs.dy.begin() + end);
+   source.insert(source.end(), rhs.source.begin() + begin, rhs.source.begin() + end);
+}
+
+/************************************
+ * CATALOG :: REMAP
+ ************************************/
+void Catalog::remap(const Relocation& moved)
+{
+   for (auto& satellite : source)
+   {
+      auto it = moved.find(satellite);
+      if (it != moved.end())
+         satellite = it->second;
+   }
+}
+
+/************************************
+ * CATALOG :: STEP
+ * Advance every object by time seconds. The preset is picked once for
+ * the whole batch, never per object.
+ ************************************/
+void Catalog::step(double time)
+{
+   switch (forces)
+   {
+   case OBLATE_EARTH:
+      step <OblateEarthModel>(time);
+      break;
+   case LOW_EARTH:
+      step <LowEarthModel>(time);
+      break;
+   default:
+      step <PointMassModel>(time);
+      break;
+   }
+}
+
+/************************************
+ * CATALOG :: PROPAGATE
+ * Advance every object by duration seconds
+ ************************************/
+void Catalog::propagate(double duration, double timeStep)
+{
+   assert(timeStep > 0.0);
+   int steps = (int)ceil(duration / timeStep);
+   for (int i = 0; i < steps; i++)
+      step(duration / (double)steps);
+}
@@ -0,0 +1,118 @@
+/***********************************************************************
+ * Header File:
+ *    Catalog
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    A flat copy of the satellites in orbit, kept as parallel arrays so
+ *    batch work (contact windows, exporters) can sweep thousands of
+ *    objects without chasing Satellite pointers.
+ ************************************************************************/
+
+#pragma once
+
+#include "position.h"
+#include "velocity.h"
+#include "physics.h"
+#include "forceModel.h"
+#include "satelliteArena.h"
+#include <list>
+#include <vector>
+
+class Satellite;
+class ShellIndex;
+
+/************************************
+ * CATALOG
+ * Position and velocity of every object, one array per component
+ ************************************/
+class Catalog
+{
+public:
+   Catalog() : forces(POINT_MASS) {}
+   Catalog(const std::list <Satellite*>& satellites) : forces(POINT_MASS) { snapshot(satellites); }
+
+   // copy the state of every satellite in orbit
+   void snapshot(const std::list <Satellite*>& satellites);
+
+   // copy only the satellites between two altitudes, in meters
+   void snapshot(const ShellIndex& index, double altitudeLow, double altitudeHigh);
+
+   // add one object to the end of the catalog
+   void add(const Position& pos, const Velocity& vel, const Satellite* source = nullptr);
+
+   // copy a range of another catalog
+   void add(const Catalog& rhs, size_t begin, size_t end);
+
+   // follow objects the arena moved
+   void remap(const Relocation& moved);
+
+   // getters
+   size_t size() const { return x.size(); }
+   bool empty() const { return x.empty(); }
+   Position getPosition(size_t i) const { return Position(x[i], y[i]); }
+   Velocity getVelocity(size_t i) const { return Velocity(dx[i], dy[i]); }
+   const Satellite* getSource(size_t i) const { return source[i]; }
+   ForcePreset getForces() const { return forces; }
+
+   // which forces act on the objects
+   void setForces(ForcePreset forces) { this->forces = forces; }
+
+   // advance every object by time seconds (kick-drift-kick)
+   void step(double time);
+
+   // advance every object by time seconds under one force model
+   template <class Model>
+   void step(double time);
+
+   // advance every object by duration seconds in steps of timeStep
+   void propagate(double duration, double timeStep);
+
+   // state of every object, meters and meters/second
+   std::vector <double> x;
+   std::vector <double> y;
+   std::vector <double> dx;
+   std::vector <double> dy;
+
+private:
+   std::vector <const Satellite*> source;   // where each row came from
+   ForcePreset forces;                      // forces acting on every row
+};
+
+/************************************
+ * CATALOG :: STEP
+ * The loops only touch the four arrays and Model::accelerate is inlined
+ * into them, so each preset compiles to one tight kernel.
+ ************************************/
+template <class Model>
+void Catalog::step(double time)
+{
+   const double half = time / 2.0;
+   const size_t n = size();
+   double* px = x.data();
+   double* py = y.data();
+   double* vx = dx.data();
+   double* vy = dy.data();
+
+   // kick and drift
+   for (size_t i = 0; i < n; i++)
+   {
+      double ddx;
+      double ddy;
+      Model::accelerate(px[i], py[i], vx[i], vy[i], ddx, ddy);
+      vx[i] += ddx * half;
+      vy[i] += ddy * half;
+      px[i] += vx[i] * time;
+      py[i] += vy[i] * time;
+   }
+
+   // kick again with the forces at the new position
+   for (size_t i = 0; i < n; i++)
+   {
+      double ddx;
+      double ddy;
+      Model::accelerate(px[i], py[i], vx[i], vy[i], ddx, ddy);
+      vx[i] += ddx * half;
+      vy[i] += ddy * half;
+   }
+}
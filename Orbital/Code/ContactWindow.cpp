@@ -0,0 +1,225 @@
+/***********************************************************************
+ * Source File:
+ *    Contact Window
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    When can a ground station see a satellite?
+ ************************************************************************/
+
+#include "contactWindow.h"
+#include "parallelFor.h"
+#include <algorithm>   // for sort
+#include <cmath>
+using namespace std;
+
+// the earth turns once a day, the same direction the satellites orbit
+const double earthRotation = -2.0 * M_PI / (24.0 * 60.0 * 60.0);
+
+/************************************
+ * ARC
+ * The state of one satellite at both ends of a sample interval.
+ * Position in between is a cubic Hermite curve through both ends.
+ ************************************/
+struct Arc
+{
+   double x0, y0, dx0, dy0;
+   double x1, y1, dx1, dy1;
+   double t0, h;
+
+   void getPosition(double t, double& x, double& y) const
+   {
+      double u = (t - t0) / h;
+      double u2 = u * u;
+      double u3 = u2 * u;
+      double h00 = 2.0 * u3 - 3.0 * u2 + 1.0;
+      double h10 = u3 - 2.0 * u2 + u;
+      double h01 = -2.0 * u3 + 3.0 * u2;
+      double h11 = u3 - u2;
+      x = h00 * x0 + h10 * h * dx0 + h01 * x1 + h11 * h * dx1;
+      y = h00 * y0 + h10 * h * dy0 + h01 * y1 + h11 * h * dy1;
+   }
+};
+
+/************************************
+ * ELEVATION
+ * Positive when the satellite is above the station's mask. This is
+ * |r| (sin(elevation) - sin(minElevation)) so it has the same sign as the
+ * elevation test without an asin().
+ ************************************/
+double elevation(const GroundStation& station, double t, double x, double y)
+{
+   double theta = station.longitude + earthRotation * t;
+   double ux = sin(theta);
+   double uy = cos(theta);
+   double rx = x - earthRadius * ux;
+   double ry = y - earthRadius * uy;
+   return rx * ux + ry * uy - sin(station.minElevation) * sqrt(rx * rx + ry * ry);
+}
+
+/************************************
+ * FIND CROSSING
+ * Illinois false position on the elevation over one arc. The bracket
+ * always holds a sign change, so this cannot wander off.
+ ************************************/
+double findCrossing(const GroundStation& station, const Arc& arc,
+                    double fLow, double fHigh, double tolerance)
+{
+   double tLow = arc.t0;
+   double tHigh = arc.t0 + arc.h;
+   int side = 0;
+
+   for (int i = 0; i < 100 && tHigh - tLow > tolerance; i++)
+   {
+      double t = (tLow * fHigh - tHigh * fLow) / (fHigh - fLow);
+      double x;
+      double y;
+      arc.getPosition(t, x, y);
+      double f = elevation(station, t, x, y);
+
+      if ((f > 0.0) == (fHigh > 0.0))
+      {
+         tHigh = t;
+         fHigh = f;
+         if (side == 1)
+            fLow /= 2.0;
+         side = 1;
+      }
+      else
+      {
+         tLow = t;
+         fLow = f;
+         if (side == -1)
+            fHigh /= 2.0;
+         side = -1;
+      }
+   }
+   return (tLow * fHigh - tHigh * fLow) / (fHigh - fLow);
+}
+
+/************************************
+ * CONTACT PLANNER :: COMPUTE
+ * Split the catalog across threads. Every thread owns its slice of
+ * satellites for the whole run so nothing is shared while working.
+ ************************************/
+vector <ContactWindow> ContactPlanner::compute(const Catalog& catalog, double duration) const
+{
+   vector <vector <ContactWindow>> results(getThreadCount(catalog.size(), threads));
+   parallelFor(catalog.size(), threads, [&](size_t slice, size_t begin, size_t end)
+   {
+      computeRange(catalog, begin, end, duration, results[slice]);
+   });
+
+   vector <ContactWindow> windows;
+   for (auto& result : results)
+      windows.insert(windows.end(), result.begin(), result.end());
+   sort(windows.begin(), windows.end(),
+        [](const ContactWindow& lhs, const ContactWindow& rhs)
+        {
+           if (lhs.station != rhs.station)
+              return lhs.station < rhs.station;
+           if (lhs.satellite != rhs.satellite)
+              return lhs.satellite < rhs.satellite;
+           return lhs.rise < rhs.rise;
+        });
+   return windows;
+}
+
+/************************************
+ * CONTACT PLANNER :: COMPUTE RANGE
+ * Step the slice forward one sample at a time. For each station the
+ * elevation of every satellite is computed in one flat loop, then a
+ * second pass looks for sign changes and refines only those.
+ ************************************/
+void ContactPlanner::computeRange(const Catalog& catalog, size_t begin, size_t end,
+                                  double duration, vector <ContactWindow>& windows) const
+{
+   const size_t n = end - begin;
+   const size_t numStations = stations.size();
+   if (n == 0 || numStations == 0)
+      return;
+
+   Catalog slice;
+   slice.setForces(catalog.getForces());
+   slice.add(catalog, begin, end);
+
+   // elevation at the last sample and when the current pass rose (-1 if none)
+   vector <double> previous(numStations * n);
+   vector <double> rise(numStations * n, -1.0);
+   vector <double> current(n);
+
+   for (size_t s = 0; s < numStations; s++)
+      for (size_t i = 0; i < n; i++)
+      {
+         previous[s * n + i] = elevation(stations[s], 0.0, slice.x[i], slice.y[i]);
+         if (previous[s * n + i] > 0.0)
+            rise[s * n + i] = 0.0;
+      }
+
+   int samples = max(1, (int)ceil(duration / sampleStep));
+   double h = duration / (double)samples;
+   int substeps = max(1, (int)ceil(h / timeStep));
+   Catalog last;
+
+   for (int k = 1; k <= samples; k++)
+   {
+      last = slice;
+      for (int sub = 0; sub < substeps; sub++)
+         slice.step(h / (double)substeps);
+      double t = h * (double)k;
+
+      for (size_t s = 0; s < numStations; s++)
+      {
+         const GroundStation& station = stations[s];
+         double theta = station.longitude + earthRotation * t;
+         double ux = sin(theta);
+         double uy = cos(theta);
+         double sx = earthRadius * ux;
+         double sy = earthRadius * uy;
+         double mask = sin(station.minElevation);
+         const double* px = slice.x.data();
+         const double* py = slice.y.data();
+         double* f = current.data();
+
+         // the batch: one station against every satellite in the slice
+         for (size_t i = 0; i < n; i++)
+         {
+            double rx = px[i] - sx;
+            double ry = py[i] - sy;
+            f[i] = rx * ux + ry * uy - mask * sqrt(rx * rx + ry * ry);
+         }
+
+         // the rare part: something rose or set during this interval
+         double* fPrevious = previous.data() + s * n;
+         for (size_t i = 0; i < n; i++)
+         {
+            if ((f[i] > 0.0) != (fPrevious[i] > 0.0))
+            {
+               Arc arc = { last.x[i], last.y[i], last.dx[i], last.dy[i],
+                           slice.x[i], slice.y[i], slice.dx[i], slice.dy[i],
+                           t - h, h };
+               double crossing = findCrossing(station, arc, fPrevious[i], f[i], tolerance);
+
+               if (f[i] > 0.0)
+                  rise[s * n + i] = crossing;
+               else
+               {
+                  ContactWindow window = { (int)s, (int)(begin + i), rise[s * n + i], crossing };
+                  windows.push_back(window);
+                  rise[s * n + i] = -1.0;
+               }
+            }
+            fPrevious[i] = f[i];
+         }
+      }
+   }
+
+   // anything still in view is cut off at the end of the run
+   for (size_t s = 0; s < numStations; s++)
+      for (size_t i = 0; i < n; i++)
+         if (rise[s * n + i] >= 0.0)
+         {
+            ContactWindow window = { (int)s, (int)(begin + i), rise[s * n + i], duration };
+            windows.push_back(window);
+         }
+}
@@ -0,0 +1,81 @@
+/***********************************************************************
+ * Header File:
+ *    Contact Window
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    When can a ground station see a satellite? Propagates a whole
+ *    catalog, tests every station against every satellite a batch at a
+ *    time, and pins down rise and set times with a root finder.
+ ************************************************************************/
+
+#pragma once
+
+#include "catalog.h"
+#include <vector>
+
+/************************************
+ * GROUND STATION
+ * A dish on the equator that turns with the earth
+ ************************************/
+struct GroundStation
+{
+   GroundStation(double longitude = 0.0, double minElevation = 0.0) :
+      longitude(longitude), minElevation(minElevation) {}
+
+   double longitude;      // radians around the earth at time zero, 0 is up
+   double minElevation;   // radians above the horizon the dish can see
+};
+
+/************************************
+ * CONTACT WINDOW
+ * One pass of one satellite over one station
+ ************************************/
+struct ContactWindow
+{
+   int station;      // index into the station list
+   int satellite;    // row in the catalog
+   double rise;      // seconds from the start of the run
+   double set;       // seconds from the start of the run
+};
+
+/************************************
+ * CONTACT PLANNER
+ * Find every contact window over a span of time
+ ************************************/
+class ContactPlanner
+{
+public:
+   ContactPlanner(const std::vector <GroundStation>& stations) :
+      stations(stations),
+      sampleStep(60.0),
+      timeStep(10.0),
+      tolerance(0.001),
+      threads(0) {}
+
+   // seconds between visibility tests. Passes shorter than this may be missed.
+   void setSampleStep(double sampleStep) { this->sampleStep = sampleStep; }
+
+   // seconds per integration step
+   void setTimeStep(double timeStep) { this->timeStep = timeStep; }
+
+   // how precisely rise and set are found, in seconds
+   void setTolerance(double tolerance) { this->tolerance = tolerance; }
+
+   // number of worker threads. Zero means one per core.
+   void setThreads(int threads) { this->threads = threads; }
+
+   // every window in [0, duration], sorted by station, satellite, then rise
+   std::vector <ContactWindow> compute(const Catalog& catalog, double duration) const;
+
+private:
+   // the windows for the catalog rows [begin, end)
+   void computeRange(const Catalog& catalog, size_t begin, size_t end,
+                     double duration, std::vector <ContactWindow>& windows) const;
+
+   std::vector <GroundStation> stations;
+   double sampleStep;
+   double timeStep;
+   double tolerance;
+   int threads;
+};
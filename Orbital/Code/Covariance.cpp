@@ -0,0 +1,268 @@
+/***********************************************************************
+ * Source File:
+ *    Covariance
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Position/velocity uncertainty and probability of collision
+ ************************************************************************/
+
+#include "covariance.h"
+#include "satellite.h"
+#include <algorithm>   // for max
+#include <cmath>
+using namespace std;
+
+const int dimensions = 4;                       // x, y, dx, dy
+const int sigmaPoints = 2 * dimensions + 1;     // center plus two per axis
+
+/************************************
+ * COVARIANCE
+ * Start with no uncertainty at all
+ ************************************/
+Covariance::Covariance()
+{
+   for (int i = 0; i < dimensions; i++)
+      for (int j = 0; j < dimensions; j++)
+         p[i][j] = 0.0;
+}
+
+/************************************
+ * COVARIANCE :: DIAGONAL
+ ************************************/
+Covariance Covariance::diagonal(double sigmaPosition, double sigmaVelocity)
+{
+   Covariance covariance;
+   covariance.p[0][0] = covariance.p[1][1] = sigmaPosition * sigmaPosition;
+   covariance.p[2][2] = covariance.p[3][3] = sigmaVelocity * sigmaVelocity;
+   return covariance;
+}
+
+/************************************
+ * CHOLESKY
+ * Lower triangular root of a covariance. Tiny negative pivots from
+ * round-off are treated as zero rather than failing.
+ ************************************/
+void cholesky(const Covariance& covariance, double root[dimensions][dimensions])
+{
+   for (int i = 0; i < dimensions; i++)
+      for (int j = 0; j < dimensions; j++)
+         root[i][j] = 0.0;
+
+   for (int j = 0; j < dimensions; j++)
+   {
+      double sum = covariance.p[j][j];
+      for (int k = 0; k < j; k++)
+         sum -= root[j][k] * root[j][k];
+      root[j][j] = sqrt(max(0.0, sum));
+
+      for (int i = j + 1; i < dimensions; i++)
+      {
+         double value = covariance.p[i][j];
+         for (int k = 0; k < j; k++)
+            value -= root[i][k] * root[j][k];
+         root[i][j] = root[j][j] > 0.0 ? value / root[j][j] : 0.0;
+      }
+   }
+}
+
+/************************************
+ * COVARIANCE TRACKER :: TRACK
+ ************************************/
+void CovarianceTracker::track(const Satellite* satellite, const Covariance& covariance)
+{
+   covariances[satellite] = covariance;
+}
+
+/************************************
+ * COVARIANCE TRACKER :: FORGET
+ ************************************/
+void CovarianceTracker::forget(const Satellite* satellite)
+{
+   covariances.erase(satellite);
+}
+
+/************************************
+ * COVARIANCE TRACKER :: REMAP
+ ************************************/
+void CovarianceTracker::remap(const Relocation& moved)
+{
+   unordered_map <const Satellite*, Covariance> remapped;
+   remapped.reserve(covariances.size());
+   for (auto& item : covariances)
+   {
+      auto it = moved.find(item.first);
+      remapped[it == moved.end() ? item.first : it->second] = item.second;
+   }
+   covariances.swap(remapped);
+}
+
+/************************************
+ * COVARIANCE TRACKER :: GET
+ ************************************/
+const Covariance* CovarianceTracker::get(const Satellite* satellite) const
+{
+   auto it = covariances.find(satellite);
+   return it == covariances.end() ? NULL : &it->second;
+}
+
+/************************************
+ * COVARIANCE TRACKER :: PROPAGATE
+ * Unscented transform with alpha = 1, beta = 2, kappa = 0. The sigma
+ * points are laid out point-major (all objects' first point, then all
+ * objects' second point, ...) so Catalog::step sweeps every object in
+ * one flat loop no matter which point it is working on.
+ ************************************/
+void CovarianceTracker::propagate(double time, double timeStep)
+{
+   const size_t n = covariances.size();
+   if (n == 0)
+      return;
+
+   const double spread = sqrt((double)dimensions);
+   const double weightMean = 1.0 / (2.0 * dimensions);
+   const double weightCenter = 2.0;   // lambda / (n + lambda) + 1 - alpha^2 + beta
+
+   vector <const Satellite*> objects;
+   objects.reserve(n);
+   for (auto& item : covariances)
+      objects.push_back(item.first);
+
+   // square roots of every covariance, once per object
+   vector <double> roots(n * dimensions * dimensions);
+   for (size_t i = 0; i < n; i++)
+      cholesky(covariances[objects[i]],
+               (double (*)[dimensions])(roots.data() + i * dimensions * dimensions));
+
+   // lay out the sigma points
+   Catalog points;
+   points.setForces(Satellite::getForces());
+   for (int k = 0; k < sigmaPoints; k++)
+      for (size_t i = 0; i < n; i++)
+      {
+         const Satellite* satellite = objects[i];
+         const double* root = roots.data() + i * dimensions * dimensions;
+
+         double state[dimensions] =
+         {
+            satellite->getPosition().getMetersX(),
+            satellite->getPosition().getMetersY(),
+            satellite->getVelocity().getDX(),
+            satellite->getVelocity().getDY()
+         };
+         if (k > 0)
+         {
+            int column = (k - 1) % dimensions;
+            double sign = k <= dimensions ? 1.0 : -1.0;
+            for (int d = 0; d < dimensions; d++)
+               state[d] += sign * spread * root[d * dimensions + column];
+         }
+         points.add(Position(state[0], state[1]), Velocity(state[2], state[3]), satellite);
+      }
+
+   points.propagate(time, timeStep);
+
+   // gather them back up
+   for (size_t i = 0; i < n; i++)
+   {
+      double landed[sigmaPoints][dimensions];
+      double mean[dimensions] = { 0.0, 0.0, 0.0, 0.0 };
+      for (int k = 0; k < sigmaPoints; k++)
+      {
+         size_t row = k * n + i;
+         landed[k][0] = points.x[row];
+         landed[k][1] = points.y[row];
+         landed[k][2] = points.dx[row];
+         landed[k][3] = points.dy[row];
+         if (k > 0)
+            for (int d = 0; d < dimensions; d++)
+               mean[d] += weightMean * landed[k][d];
+      }
+
+      Covariance& covariance = covariances[objects[i]];
+      for (int a = 0; a < dimensions; a++)
+         for (int b = 0; b < dimensions; b++)
+         {
+            double sum = weightCenter * (landed[0][a] - mean[a]) * (landed[0][b] - mean[b]);
+            for (int k = 1; k < sigmaPoints; k++)
+               sum += weightMean * (landed[k][a] - mean[a]) * (landed[k][b] - mean[b]);
+            covariance.p[a][b] = sum;
+         }
+   }
+}
+
+/************************************
+ * COVARIANCE TRACKER :: PROBABILITY
+ * Short encounter: both objects move in straight lines near closest
+ * approach. In the plane the "encounter plane" is the line across the
+ * relative velocity, so the combined position covariance is projected
+ * onto it and the chance is the Gaussian mass within the hard body
+ * radius of the predicted miss.
+ ************************************/
+double CovarianceTracker::probability(const Satellite* first, const Satellite* second,
+                                      double hardBodyRadius) const
+{
+   const Covariance* pFirst = get(first);
+   const Covariance* pSecond = get(second);
+   if (pFirst == NULL || pSecond == NULL)
+      return 0.0;
+
+   double rx = second->getPosition().getMetersX() - first->getPosition().getMetersX();
+   double ry = second->getPosition().getMetersY() - first->getPosition().getMetersY();
+   double vx = second->getVelocity().getDX() - first->getVelocity().getDX();
+   double vy = second->getVelocity().getDY() - first->getVelocity().getDY();
+   double speed = sqrt(vx * vx + vy * vy);
+
+   // direction across the relative velocity
+   double ux = speed > 0.0 ? -vy / speed : 1.0;
+   double uy = speed > 0.0 ? vx / speed : 0.0;
+   double miss = rx * ux + ry * uy;
+
+   double variance = 0.0;
+   double u[2] = { ux, uy };
+   for (int a = 0; a < 2; a++)
+      for (int b = 0; b < 2; b++)
+         variance += u[a] * (pFirst->p[a][b] + pSecond->p[a][b]) * u[b];
+
+   if (variance <= 0.0)
+      return fabs(miss) < hardBodyRadius ? 1.0 : 0.0;
+
+   double sigma = sqrt(2.0 * variance);
+   return 0.5 * (erf((hardBodyRadius - miss) / sigma) - erf((-hardBodyRadius - miss) / sigma));
+}
+
+/************************************
+ * COVARIANCE TRACKER :: SCREEN
+ * Check every tracked pair. The hard body is the two radii added.
+ ************************************/
+vector <Conjunction> CovarianceTracker::screen(double distance) const
+{
+   vector <const Satellite*> objects;
+   for (auto& item : covariances)
+      objects.push_back(item.first);
+
+   vector <Conjunction> conjunctions;
+   for (size_t i = 0; i < objects.size(); i++)
+      for (size_t j = i + 1; j < objects.size(); j++)
+      {
+         double separation = computeDistance(objects[i]->getPosition(), objects[j]->getPosition());
+         if (separation < distance)
+         {
+            // closest approach if both keep going in a straight line
+            double rx = objects[j]->getPosition().getMetersX() - objects[i]->getPosition().getMetersX();
+            double ry = objects[j]->getPosition().getMetersY() - objects[i]->getPosition().getMetersY();
+            double vx = objects[j]->getVelocity().getDX() - objects[i]->getVelocity().getDX();
+            double vy = objects[j]->getVelocity().getDY() - objects[i]->getVelocity().getDY();
+            double speed = sqrt(vx * vx + vy * vy);
+
+            Conjunction conjunction;
+            conjunction.first = objects[i];
+            conjunction.second = objects[j];
+            conjunction.missDistance = speed > 0.0 ? fabs(rx * vy - ry * vx) / speed : separation;
+            conjunction.probability = probability(objects[i], objects[j],
+               objects[i]->getRadius() + objects[j]->getRadius());
+            conjunctions.push_back(conjunction);
+         }
+      }
+   return conjunctions;
+}
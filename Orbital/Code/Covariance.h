@@ -0,0 +1,86 @@
+/***********************************************************************
+ * Header File:
+ *    Covariance
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    How sure are we where an object is? Each tracked satellite carries
+ *    a position/velocity covariance that is pushed forward with the
+ *    unscented transform: a handful of sigma points per object fly
+ *    through the same Catalog propagator as everything else, all objects
+ *    side by side, and the spread of where they land is the new
+ *    covariance. Close pairs get a probability of collision.
+ ************************************************************************/
+
+#pragma once
+
+#include "catalog.h"
+#include "satelliteArena.h"
+#include <unordered_map>
+#include <vector>
+
+class Satellite;
+
+/************************************
+ * COVARIANCE
+ * 4x4 over x, y, dx, dy in meters and meters/second
+ ************************************/
+struct Covariance
+{
+   Covariance();
+
+   // independent errors in position and velocity
+   static Covariance diagonal(double sigmaPosition, double sigmaVelocity);
+
+   double p[4][4];
+};
+
+/************************************
+ * CONJUNCTION
+ * Two tracked objects that come close
+ ************************************/
+struct Conjunction
+{
+   const Satellite* first;
+   const Satellite* second;
+   double missDistance;     // meters at closest approach
+   double probability;      // chance they hit
+};
+
+/************************************
+ * COVARIANCE TRACKER
+ * The covariance of every tracked satellite
+ ************************************/
+class CovarianceTracker
+{
+public:
+   CovarianceTracker() {}
+
+   // start (or restart) tracking an object
+   void track(const Satellite* satellite, const Covariance& covariance);
+
+   // stop tracking an object
+   void forget(const Satellite* satellite);
+
+   // follow objects the arena moved
+   void remap(const Relocation& moved);
+
+   // the covariance of an object, or NULL if it is not tracked
+   const Covariance* get(const Satellite* satellite) const;
+
+   size_t size() const { return covariances.size(); }
+
+   // push every covariance forward by time seconds from where the
+   // satellites are now. Call before the satellites themselves move.
+   void propagate(double time, double timeStep);
+
+   // probability two tracked objects collide, given their combined radius
+   double probability(const Satellite* first, const Satellite* second,
+                      double hardBodyRadius) const;
+
+   // every tracked pair closer than distance, with its probability
+   std::vector <Conjunction> screen(double distance) const;
+
+private:
+   std::unordered_map <const Satellite*, Covariance> covariances;
+};
@@ -0,0 +1,254 @@
+/***********************************************************************
+ * Source File:
+ *    Ephemeris
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Save and query piecewise Chebyshev fits of every object's path
+ ************************************************************************/
+
+#include "ephemeris.h"
+#include "trajectory.h"
+#include "parallelFor.h"
+#include <algorithm>   // for min and max
+#include <atomic>
+#include <cmath>
+#include <cstring>     // for memcmp
+#include <fstream>
+using namespace std;
+
+#define EPHEMERIS_MAX_DEGREE 64   // far past any useful fit; anything more is a bad file
+
+/************************************
+ * CHEBYSHEV
+ * Clenshaw's recurrence for sum c_j T_j(tau), tau in [-1, 1]
+ ************************************/
+inline double chebyshev(const float* c, int degree, double tau)
+{
+   double b1 = 0.0;
+   double b2 = 0.0;
+   for (int j = degree; j >= 1; j--)
+   {
+      double b0 = 2.0 * tau * b1 - b2 + c[j];
+      b2 = b1;
+      b1 = b0;
+   }
+   return tau * b1 - b2 + c[0];
+}
+
+/************************************
+ * FIT SEGMENT
+ * Interpolate the path at the Chebyshev nodes of [start, start + length],
+ * round to float the way the file stores it, and return the worst miss
+ * in meters at four times as many points in between.
+ ************************************/
+double fitSegment(const Trajectory& path, double start, double length, int degree,
+                  float* cx, float* cy)
+{
+   int n = degree + 1;
+   vector <double> fx(n);
+   vector <double> fy(n);
+   double x, y, dx, dy;
+
+   for (int k = 0; k < n; k++)
+   {
+      double node = cos(M_PI * (k + 0.5) / n);
+      path.getState(start + (node + 1.0) * 0.5 * length, fx[k], fy[k], dx, dy);
+   }
+
+   for (int j = 0; j < n; j++)
+   {
+      double sumX = 0.0;
+      double sumY = 0.0;
+      for (int k = 0; k < n; k++)
+      {
+         double weight = cos(M_PI * j * (k + 0.5) / n);
+         sumX += fx[k] * weight;
+         sumY += fy[k] * weight;
+      }
+      double scale = (j == 0 ? 1.0 : 2.0) / n;
+      cx[j] = (float)(sumX * scale);
+      cy[j] = (float)(sumY * scale);
+   }
+
+   double error = 0.0;
+   int checks = 4 * n;
+   for (int k = 0; k <= checks; k++)
+   {
+      double tau = -1.0 + 2.0 * k / checks;
+      path.getState(start + (tau + 1.0) * 0.5 * length, x, y, dx, dy);
+      double ex = chebyshev(cx, degree, tau) - x;
+      double ey = chebyshev(cy, degree, tau) - y;
+      error = max(error, sqrt(ex * ex + ey * ey));
+   }
+   return error;
+}
+
+/************************************
+ * EPHEMERIS WRITER :: WRITE
+ * Fit slices of the catalog in parallel, then write them in order
+ ************************************/
+bool EphemerisWriter::write(const string& fileName, const Catalog& catalog, double duration) const
+{
+   size_t n = catalog.size();
+   vector <EphemerisIndex> index(n);
+   vector <vector <float>> coefficients(n);
+
+   atomic <bool> missed(false);
+   parallelFor(n, threads, [&](size_t, size_t begin, size_t end)
+   {
+      fitRange(catalog, begin, end, duration, index, coefficients, missed);
+   });
+   if (missed)
+      return false;
+
+   EphemerisHeader header;
+   memcpy(header.magic, "EPH1", 4);
+   header.objects = (uint32_t)n;
+   header.degree = (uint32_t)degree;
+   header.reserved = 0;
+   header.duration = duration;
+
+   uint64_t offset = 0;
+   for (size_t i = 0; i < n; i++)
+   {
+      index[i].offset = offset;
+      offset += coefficients[i].size();
+   }
+
+   ofstream fout(fileName.c_str(), ios::binary);
+   if (!fout.is_open())
+      return false;
+   fout.write((const char*)&header, sizeof(header));
+   fout.write((const char*)index.data(), sizeof(EphemerisIndex) * n);
+   for (auto& object : coefficients)
+      fout.write((const char*)object.data(), sizeof(float) * object.size());
+   return fout.good();
+}
+
+/************************************
+ * EPHEMERIS WRITER :: FIT RANGE
+ * A few dozen objects at a time are flown for the whole span, then each
+ * is split into halves, quarters, ... until every segment fits. One
+ * that still misses once segments are a few samples long is reported.
+ ************************************/
+void EphemerisWriter::fitRange(const Catalog& catalog, size_t begin, size_t end, double duration,
+                               vector <EphemerisIndex>& index,
+                               vector <vector <float>>& coefficients,
+                               atomic <bool>& missed) const
+{
+   const size_t chunk = 64;
+   const int perSegment = 2 * (degree + 1);
+
+   for (size_t first = begin; first < end; first += chunk)
+   {
+      size_t last = min(end, first + chunk);
+      Catalog slice;
+      slice.setForces(catalog.getForces());
+      slice.add(catalog, first, last);
+      vector <Trajectory> paths = recordTrajectories(slice, duration, timeStep);
+
+      for (size_t row = first; row < last; row++)
+      {
+         const Trajectory& path = paths[row - first];
+         vector <float>& fit = coefficients[row];
+         int segments = 1;
+
+         while (true)
+         {
+            double length = duration / segments;
+            double error = 0.0;
+            fit.assign((size_t)segments * perSegment, 0.0f);
+            for (int s = 0; s < segments; s++)
+            {
+               float* cx = fit.data() + (size_t)s * perSegment;
+               error = max(error, fitSegment(path, s * length, length, degree, cx, cx + degree + 1));
+            }
+
+            if (error <= tolerance)
+               break;
+
+            // give up splitting once segments are shorter than a few samples
+            if (length < 4.0 * timeStep)
+            {
+               missed = true;
+               break;
+            }
+            segments *= 2;
+         }
+
+         index[row].segments = (uint32_t)segments;
+         index[row].reserved = 0;
+         index[row].segmentLength = duration / segments;
+      }
+   }
+}
+
+/************************************
+ * EPHEMERIS :: OPEN
+ * Read the whole file. It is small enough to keep in memory. Nothing in
+ * it is trusted: every segment of every object must be inside the
+ * coefficients actually there, or the file is refused.
+ ************************************/
+bool Ephemeris::open(const string& fileName)
+{
+   index.clear();
+   coefficients.clear();
+   degree = 0;
+   duration = 0.0;
+
+   ifstream fin(fileName.c_str(), ios::binary | ios::ate);
+   if (!fin.is_open())
+      return false;
+   uint64_t fileSize = (uint64_t)fin.tellg();
+   fin.seekg(0);
+
+   EphemerisHeader header;
+   if (!fin.read((char*)&header, sizeof(header)) ||
+       memcmp(header.magic, "EPH1", 4) != 0 ||
+       header.degree > EPHEMERIS_MAX_DEGREE ||
+       !(header.duration > 0.0) || !std::isfinite(header.duration) ||
+       header.objects > (fileSize - sizeof(header)) / sizeof(EphemerisIndex))
+      return false;
+
+   vector <EphemerisIndex> entries(header.objects);
+   if (!fin.read((char*)entries.data(), sizeof(EphemerisIndex) * entries.size()))
+      return false;
+
+   uint64_t total = (fileSize - sizeof(header) - sizeof(EphemerisIndex) * entries.size()) /
+                    sizeof(float);
+   uint64_t perSegment = 2 * ((uint64_t)header.degree + 1);
+   for (const EphemerisIndex& entry : entries)
+      if (entry.segments < 1 || !(entry.segmentLength > 0.0) ||
+          !std::isfinite(entry.segmentLength) || entry.offset > total ||
+          (uint64_t)entry.segments > (total - entry.offset) / perSegment)
+         return false;
+
+   vector <float> read(total);
+   if (!fin.read((char*)read.data(), sizeof(float) * total))
+      return false;
+
+   degree = (int)header.degree;
+   duration = header.duration;
+   index.swap(entries);
+   coefficients.swap(read);
+   return true;
+}
+
+/************************************
+ * EPHEMERIS :: GET POSITION
+ * One divide picks the segment, then one polynomial per axis
+ ************************************/
+Position Ephemeris::getPosition(size_t object, double t) const
+{
+   assert(object < index.size());
+   const EphemerisIndex& entry = index[object];
+
+   t = max(0.0, min(duration, t));
+   uint32_t segment = min(entry.segments - 1, (uint32_t)(t / entry.segmentLength));
+   double tau = 2.0 * (t - segment * entry.segmentLength) / entry.segmentLength - 1.0;
+
+   const float* cx = coefficients.data() + entry.offset + (size_t)segment * 2 * (degree + 1);
+   const float* cy = cx + degree + 1;
+   return Position(chebyshev(cx, degree, tau), chebyshev(cy, degree, tau));
+}
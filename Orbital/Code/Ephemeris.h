@@ -0,0 +1,109 @@
+/***********************************************************************
+ * Header File:
+ *    Ephemeris
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Where was an object at time t? The writer fits piecewise Chebyshev
+ *    polynomials to every object's path and saves the coefficients to a
+ *    small indexed file. The reader finds the segment with one divide and
+ *    sums one short polynomial per axis.
+ *
+ *    File layout, all native byte order:
+ *       EphemerisHeader
+ *       EphemerisIndex  one per object
+ *       float           (degree + 1) x coefficients then (degree + 1) y
+ *                       coefficients, for every segment of every object
+ ************************************************************************/
+
+#pragma once
+
+#include "catalog.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/************************************
+ * EPHEMERIS HEADER
+ ************************************/
+struct EphemerisHeader
+{
+   char magic[4];        // "EPH1"
+   uint32_t objects;     // number of objects in the file
+   uint32_t degree;      // degree of every polynomial
+   uint32_t reserved;
+   double duration;      // seconds covered, starting at zero
+};
+
+/************************************
+ * EPHEMERIS INDEX
+ * Every segment of one object is the same length, so finding the right
+ * one is a divide instead of a search.
+ ************************************/
+struct EphemerisIndex
+{
+   uint64_t offset;          // first coefficient, counted in floats
+   uint32_t segments;        // number of segments
+   uint32_t reserved;
+   double segmentLength;     // seconds per segment
+};
+
+/************************************
+ * EPHEMERIS WRITER
+ * Propagate a catalog and save its Chebyshev fit
+ ************************************/
+class EphemerisWriter
+{
+public:
+   EphemerisWriter(double tolerance = 10.0, int degree = 12) :
+      tolerance(tolerance), degree(degree), timeStep(10.0), threads(0) {}
+
+   // seconds per integration step
+   void setTimeStep(double timeStep) { this->timeStep = timeStep; }
+
+   // number of worker threads. Zero means one per core.
+   void setThreads(int threads) { this->threads = threads; }
+
+   // fit every object over [0, duration] and write the file. False if it
+   // cannot be written, or some path cannot be fit to the tolerance.
+   bool write(const std::string& fileName, const Catalog& catalog, double duration) const;
+
+private:
+   // fit the catalog rows [begin, end), setting missed if one will not fit
+   void fitRange(const Catalog& catalog, size_t begin, size_t end, double duration,
+                 std::vector <EphemerisIndex>& index,
+                 std::vector <std::vector <float>>& coefficients,
+                 std::atomic <bool>& missed) const;
+
+   double tolerance;   // meters
+   int degree;
+   double timeStep;
+   int threads;
+};
+
+/************************************
+ * EPHEMERIS
+ * Query a file made by EphemerisWriter
+ ************************************/
+class Ephemeris
+{
+public:
+   Ephemeris() : degree(0), duration(0.0) {}
+
+   // load a file. False, and empty, if it is not a whole ephemeris.
+   bool open(const std::string& fileName);
+
+   // getters
+   size_t size() const { return index.size(); }
+   double getDuration() const { return duration; }
+
+   // where an object was at time t, clamped to the span of the file
+   Position getPosition(size_t object, double t) const;
+
+private:
+   int degree;
+   double duration;
+   std::vector <EphemerisIndex> index;
+   std::vector <float> coefficients;
+};
@@ -0,0 +1,142 @@
+/***********************************************************************
+ * Header File:
+ *    Force Model
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The forces acting on an object in orbit. Each force is a small
+ *    policy type and ForceModel<...> adds them together at compile time,
+ *    so ForceModel<PointMass, J2> is a single inlined function with no
+ *    branches. Only the presets below are ever instantiated.
+ ************************************************************************/
+
+#pragma once
+
+#include "acceleration.h"
+#include "position.h"
+#include "velocity.h"
+#include "physics.h"
+#include <cmath>
+
+/************************************
+ * POINT MASS
+ * Earth as a point at the origin: g_0 (R_e / r) ^ 2
+ ************************************/
+struct PointMass
+{
+   static void accelerate(double x, double y, double dx, double dy,
+                          double& ddx, double& ddy)
+   {
+      const double mu = standardGravity * earthRadius * earthRadius;
+      double r2 = x * x + y * y;
+      double scale = -mu / (r2 * sqrt(r2));
+      ddx += scale * x;
+      ddy += scale * y;
+   }
+};
+
+/************************************
+ * J2
+ * Earth's equatorial bulge. Everything orbits in the equatorial plane
+ * here, so the term is purely radial: 3/2 J2 mu R_e^2 / r^4
+ ************************************/
+struct J2
+{
+   static void accelerate(double x, double y, double dx, double dy,
+                          double& ddx, double& ddy)
+   {
+      const double j2 = 1.08263e-3;
+      const double mu = standardGravity * earthRadius * earthRadius;
+      double r2 = x * x + y * y;
+      double scale = -1.5 * j2 * mu * earthRadius * earthRadius / (r2 * r2 * sqrt(r2));
+      ddx += scale * x;
+      ddy += scale * y;
+   }
+};
+
+/************************************
+ * EXPONENTIAL DRAG
+ * Air drag from a single scale height atmosphere turning with the
+ * earth. Only matters for low fragments; far away the density is so
+ * small the term is zero.
+ ************************************/
+struct ExponentialDrag
+{
+   static void accelerate(double x, double y, double dx, double dy,
+                          double& ddx, double& ddy)
+   {
+      const double densityReference = 2.8e-12;     // kg/m^3 at 400 km
+      const double altitudeReference = 400000.0;  // m
+      const double scaleHeight = 58500.0;         // m
+      const double ballistic = 0.01;              // Cd A / m in m^2/kg
+      const double rotation = 2.0 * M_PI / (24.0 * 60.0 * 60.0);
+
+      double altitude = sqrt(x * x + y * y) - earthRadius;
+      double density = densityReference * exp((altitudeReference - altitude) / scaleHeight);
+
+      // velocity relative to the air, which turns with the earth
+      double vx = dx + rotation * y;
+      double vy = dy - rotation * x;
+      double scale = -0.5 * density * ballistic * sqrt(vx * vx + vy * vy);
+      ddx += scale * vx;
+      ddy += scale * vy;
+   }
+};
+
+/************************************
+ * FORCE MODEL
+ * The sum of any number of forces
+ ************************************/
+template <class ... Forces>
+struct ForceModel
+{
+   static void accelerate(double x, double y, double dx, double dy,
+                          double& ddx, double& ddy)
+   {
+      ddx = 0.0;
+      ddy = 0.0;
+      (Forces::accelerate(x, y, dx, dy, ddx, ddy), ...);
+   }
+};
+
+/************************************
+ * FORCE PRESET
+ * The combinations we actually compile
+ ************************************/
+enum ForcePreset
+{
+   POINT_MASS,      // just gravity
+   OBLATE_EARTH,    // gravity and J2
+   LOW_EARTH        // gravity, J2, and drag
+};
+
+typedef ForceModel <PointMass>                       PointMassModel;
+typedef ForceModel <PointMass, J2>                   OblateEarthModel;
+typedef ForceModel <PointMass, J2, ExponentialDrag>  LowEarthModel;
+
+/************************************
+ * GET ACCELERATION
+ * Total acceleration on one object from a preset
+ ************************************/
+inline Acceleration getAcceleration(ForcePreset forces, const Position& pos, const Velocity& vel)
+{
+   double ddx;
+   double ddy;
+   double x = pos.getMetersX();
+   double y = pos.getMetersY();
+
+   switch (forces)
+   {
+   case OBLATE_EARTH:
+      OblateEarthModel::accelerate(x, y, vel.getDX(), vel.getDY(), ddx, ddy);
+      break;
+   case LOW_EARTH:
+      LowEarthModel::accelerate(x, y, vel.getDX(), vel.getDY(), ddx, ddy);
+      break;
+   default:
+      PointMassModel::accelerate(x, y, vel.getDX(), vel.getDY(), ddx, ddy);
+      break;
+   }
+
+   return Acceleration(ddx, ddy);
+}
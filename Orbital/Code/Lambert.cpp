@@ -0,0 +1,253 @@
+/***********************************************************************
+ * Source File:
+ *    Lambert
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Plan a transfer from the ship to another satellite
+ ************************************************************************/
+
+#include "lambert.h"
+#include "satellite.h"
+#include "parallelFor.h"
+#include <algorithm>   // for min and max
+#include <cmath>
+#include <limits>      // for NaN
+using namespace std;
+
+/************************************
+ * STUMPFF
+ * C(z) and S(z) from the universal variable formulation. Near zero the
+ * closed forms cancel badly, so use the first terms of the series.
+ ************************************/
+inline void stumpff(double z, double& c, double& s)
+{
+   if (z > 1.0e-6)
+   {
+      double root = sqrt(z);
+      c = (1.0 - cos(root)) / z;
+      s = (root - sin(root)) / (root * root * root);
+   }
+   else if (z < -1.0e-6)
+   {
+      double root = sqrt(-z);
+      c = (cosh(root) - 1.0) / -z;
+      s = (sinh(root) - root) / (root * root * root);
+   }
+   else
+   {
+      c = 0.5 - z / 24.0;
+      s = 1.0 / 6.0 - z / 120.0;
+   }
+}
+
+/************************************
+ * SOLVE LAMBERT
+ * Universal variables (Bate, Mueller & White). The time of flight grows
+ * with z, so every cell keeps a bracket between a deep hyperbola and one
+ * full revolution and takes Newton steps inside it, falling back to
+ * bisection when Newton would leave. A fixed number of iterations keeps
+ * every lane in step.
+ ************************************/
+void solveLambert(double x1, double y1,
+                  const double* x2, const double* y2, const double* dt,
+                  double* dx1, double* dy1, double* dx2, double* dy2,
+                  size_t n)
+{
+   const double mu = standardGravity * earthRadius * earthRadius;
+   const double rootMu = sqrt(mu);
+   const double zMin = -400.0;
+   const double zMax = 4.0 * M_PI * M_PI * (1.0 - 1.0e-9);
+   const int iterations = 24;
+   double r1 = sqrt(x1 * x1 + y1 * y1);
+
+   vector <double> a(n);
+   vector <double> r2(n);
+   vector <double> low(n, zMin);
+   vector <double> high(n, zMax);
+   vector <double> z(n, 0.0);
+
+   // geometry of each transfer: the A constant depends only on the angle swept
+   for (size_t i = 0; i < n; i++)
+   {
+      r2[i] = sqrt(x2[i] * x2[i] + y2[i] * y2[i]);
+      double cosAngle = (x1 * x2[i] + y1 * y2[i]) / (r1 * r2[i]);
+      cosAngle = max(-1.0, min(1.0, cosAngle));
+      double angle = acos(cosAngle);
+      if (x1 * y2[i] - y1 * x2[i] < 0.0)
+         angle = 2.0 * M_PI - angle;
+      a[i] = sin(angle) * sqrt(r1 * r2[i] / (1.0 - cosAngle));
+   }
+
+   // solve every cell together
+   for (int iteration = 0; iteration < iterations; iteration++)
+      for (size_t i = 0; i < n; i++)
+      {
+         double c;
+         double s;
+         stumpff(z[i], c, s);
+         double y = r1 + r2[i] + a[i] * (z[i] * s - 1.0) / sqrt(c);
+         double ratio = y / c;
+         double f = ratio * sqrt(ratio) * s + a[i] * sqrt(y) - rootMu * dt[i];
+
+         // y < 0 means z is too small to reach at all
+         bool tooShort = y < 0.0 || f < 0.0;
+         low[i] = tooShort ? z[i] : low[i];
+         high[i] = tooShort ? high[i] : z[i];
+
+         // derivative of the time of flight with respect to z
+         double slope = fabs(z[i]) > 1.0e-6 ?
+            ratio * sqrt(ratio) * ((c - 1.5 * s / c) / (2.0 * z[i]) + 0.75 * s * s / c) +
+               a[i] / 8.0 * (3.0 * s / c * sqrt(y) + a[i] * sqrt(c / y)) :
+            sqrt(2.0) / 40.0 * y * sqrt(y) +
+               a[i] / 8.0 * (sqrt(y) + a[i] * sqrt(1.0 / (2.0 * y)));
+
+         double next = z[i] - f / slope;
+         bool inside = y > 0.0 && next > low[i] && next < high[i];
+         z[i] = inside ? next : 0.5 * (low[i] + high[i]);
+      }
+
+   // Lagrange coefficients give the two velocities
+   for (size_t i = 0; i < n; i++)
+   {
+      double c;
+      double s;
+      stumpff(z[i], c, s);
+      double y = r1 + r2[i] + a[i] * (z[i] * s - 1.0) / sqrt(c);
+      bool valid = y > 0.0 && fabs(a[i]) > 1.0e-6 &&
+                   z[i] > zMin + 1.0e-6 && z[i] < zMax - 1.0e-6;
+      if (!valid)
+      {
+         dx1[i] = dy1[i] = dx2[i] = dy2[i] = numeric_limits <double>::quiet_NaN();
+         continue;
+      }
+
+      double f = 1.0 - y / r1;
+      double g = a[i] * sqrt(y / mu);
+      double gDot = 1.0 - y / r2[i];
+      dx1[i] = (x2[i] - f * x1) / g;
+      dy1[i] = (y2[i] - f * y1) / g;
+      dx2[i] = (gDot * x2[i] - x1) / g;
+      dy2[i] = (gDot * y2[i] - y1) / g;
+   }
+}
+
+/************************************
+ * INTERCEPT PLANNER
+ * Remember where the ship and the target are now
+ ************************************/
+InterceptPlanner::InterceptPlanner(const Satellite& ship, const Satellite& target) :
+   departureFirst(0.0),
+   departureLast(3600.0),
+   departureCount(60),
+   timeOfFlightShortest(600.0),
+   timeOfFlightLongest(6.0 * 3600.0),
+   timeOfFlightCount(120),
+   rendezvous(false),
+   threads(0)
+{
+   start.add(ship.getPosition(), ship.getVelocity(), &ship);
+   start.add(target.getPosition(), target.getVelocity(), &target);
+}
+
+/************************************
+ * INTERCEPT PLANNER :: SET DEPARTURES
+ ************************************/
+void InterceptPlanner::setDepartures(double first, double last, int count)
+{
+   assert(count > 0 && last >= first);
+   departureFirst = first;
+   departureLast = last;
+   departureCount = count;
+}
+
+/************************************
+ * INTERCEPT PLANNER :: SET TIMES OF FLIGHT
+ ************************************/
+void InterceptPlanner::setTimesOfFlight(double shortest, double longest, int count)
+{
+   assert(count > 0 && longest >= shortest && shortest > 0.0);
+   timeOfFlightShortest = shortest;
+   timeOfFlightLongest = longest;
+   timeOfFlightCount = count;
+}
+
+/************************************
+ * INTERCEPT PLANNER :: GET COST
+ ************************************/
+double InterceptPlanner::getCost(const Transfer& transfer) const
+{
+   return transfer.departureDeltaV + (rendezvous ? transfer.arrivalDeltaV : 0.0);
+}
+
+/************************************
+ * INTERCEPT PLANNER :: PLAN
+ * Fly both objects once to the end of the grid, then hand rows of the
+ * plot to the worker threads.
+ ************************************/
+Transfer InterceptPlanner::plan()
+{
+   vector <Trajectory> paths = recordTrajectories(start, departureLast + timeOfFlightLongest, 10.0);
+   ship = paths[0];
+   target = paths[1];
+
+   porkchop.assign((size_t)departureCount * timeOfFlightCount, Transfer());
+
+   parallelFor(departureCount, threads, [this](size_t, size_t begin, size_t end)
+   {
+      planRows((int)begin, (int)end);
+   });
+
+   Transfer best;
+   for (auto& transfer : porkchop)
+      if (transfer.valid && (!best.valid || getCost(transfer) < getCost(best)))
+         best = transfer;
+   return best;
+}
+
+/************************************
+ * INTERCEPT PLANNER :: PLAN ROWS
+ * Every cell in a row leaves from the same place, so one call to
+ * solveLambert() does the whole row.
+ ************************************/
+void InterceptPlanner::planRows(int begin, int end)
+{
+   size_t n = timeOfFlightCount;
+   vector <double> x2(n), y2(n), dt(n);
+   vector <double> targetDX(n), targetDY(n);
+   vector <double> dx1(n), dy1(n), dx2(n), dy2(n);
+   double departureStep = departureCount > 1 ?
+      (departureLast - departureFirst) / (double)(departureCount - 1) : 0.0;
+   double timeOfFlightStep = timeOfFlightCount > 1 ?
+      (timeOfFlightLongest - timeOfFlightShortest) / (double)(timeOfFlightCount - 1) : 0.0;
+
+   for (int row = begin; row < end; row++)
+   {
+      double departure = departureFirst + departureStep * (double)row;
+      double x1, y1, shipDX, shipDY;
+      ship.getState(departure, x1, y1, shipDX, shipDY);
+
+      for (size_t j = 0; j < n; j++)
+      {
+         dt[j] = timeOfFlightShortest + timeOfFlightStep * (double)j;
+         target.getState(departure + dt[j], x2[j], y2[j], targetDX[j], targetDY[j]);
+      }
+
+      solveLambert(x1, y1, x2.data(), y2.data(), dt.data(),
+                   dx1.data(), dy1.data(), dx2.data(), dy2.data(), n);
+
+      for (size_t j = 0; j < n; j++)
+      {
+         Transfer& transfer = porkchop[(size_t)row * n + j];
+         transfer.departure = departure;
+         transfer.timeOfFlight = dt[j];
+         transfer.valid = !std::isnan(dx1[j]);
+         if (!transfer.valid)
+            continue;
+         transfer.burn = Velocity(dx1[j] - shipDX, dy1[j] - shipDY);
+         transfer.departureDeltaV = transfer.burn.getSpeed();
+         transfer.arrivalDeltaV = sqrt((targetDX[j] - dx2[j]) * (targetDX[j] - dx2[j]) +
+                                       (targetDY[j] - dy2[j]) * (targetDY[j] - dy2[j]));
+      }
+   }
+}
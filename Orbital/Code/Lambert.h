@@ -0,0 +1,98 @@
+/***********************************************************************
+ * Header File:
+ *    Lambert
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Plan a transfer from the ship to another satellite. Lambert's
+ *    problem is solved for every departure time and time of flight on a
+ *    grid (a porkchop plot) and the cheapest intercept is returned.
+ ************************************************************************/
+
+#pragma once
+
+#include "catalog.h"
+#include "trajectory.h"
+#include <vector>
+
+class Satellite;
+
+/************************************
+ * TRANSFER
+ * One cell of the porkchop plot
+ ************************************/
+struct Transfer
+{
+   Transfer() : departure(0.0), timeOfFlight(0.0), departureDeltaV(0.0),
+                arrivalDeltaV(0.0), valid(false) {}
+
+   double departure;         // seconds from now until the burn
+   double timeOfFlight;      // seconds from the burn until we get there
+   Velocity burn;            // change in velocity at departure
+   double departureDeltaV;   // m/s to leave
+   double arrivalDeltaV;     // m/s to match velocity on arrival
+   bool valid;               // did Lambert converge
+};
+
+/************************************
+ * SOLVE LAMBERT
+ * Prograde, single revolution transfers that all start at the same
+ * point (x1, y1) and end at (x2[i], y2[i]) after dt[i] seconds. The
+ * departure velocity goes to dx1, dy1 and the arrival velocity to
+ * dx2, dy2. Every solve runs the same number of iterations side by side
+ * so the loops vectorize. Unsolvable cells come back as NaN.
+ ************************************/
+void solveLambert(double x1, double y1,
+                  const double* x2, const double* y2, const double* dt,
+                  double* dx1, double* dy1, double* dx2, double* dy2,
+                  size_t n);
+
+/************************************
+ * INTERCEPT PLANNER
+ * Search departure time x time of flight for the cheapest way there
+ ************************************/
+class InterceptPlanner
+{
+public:
+   InterceptPlanner(const Satellite& ship, const Satellite& target);
+
+   // the grid of departure times, in seconds from now
+   void setDepartures(double first, double last, int count);
+
+   // the grid of times of flight, in seconds
+   void setTimesOfFlight(double shortest, double longest, int count);
+
+   // count arrival delta-v too (rendezvous instead of intercept)
+   void setRendezvous(bool rendezvous) { this->rendezvous = rendezvous; }
+
+   // number of worker threads. Zero means one per core.
+   void setThreads(int threads) { this->threads = threads; }
+
+   // fill the porkchop plot and return the cheapest cell
+   Transfer plan();
+
+   // the plot itself, departure major
+   const std::vector <Transfer>& getPorkchop() const { return porkchop; }
+   int getDepartureCount() const { return departureCount; }
+   int getTimeOfFlightCount() const { return timeOfFlightCount; }
+
+private:
+   // fill the rows [begin, end) of the plot
+   void planRows(int begin, int end);
+
+   // cost used to pick the best cell
+   double getCost(const Transfer& transfer) const;
+
+   Catalog start;                  // ship in row 0, target in row 1
+   Trajectory ship;
+   Trajectory target;
+   double departureFirst;
+   double departureLast;
+   int departureCount;
+   double timeOfFlightShortest;
+   double timeOfFlightLongest;
+   int timeOfFlightCount;
+   bool rendezvous;
+   int threads;
+   std::vector <Transfer> porkchop;
+};
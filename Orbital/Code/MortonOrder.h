@@ -0,0 +1,51 @@
+/***********************************************************************
+ * Header File:
+ *    Morton Order
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Z-order keys for points in the plane. Interleaving the bits of the
+ *    two coordinates gives a single number where objects that are close
+ *    in space are usually close in the order too.
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>   // for min and max
+#include <cstdint>
+
+/************************************
+ * SPREAD BITS
+ * Put a zero between every bit of a 32 bit number
+ ************************************/
+inline uint64_t spreadBits(uint32_t value)
+{
+   uint64_t bits = value;
+   bits = (bits | (bits << 16)) & 0x0000FFFF0000FFFFull;
+   bits = (bits | (bits << 8))  & 0x00FF00FF00FF00FFull;
+   bits = (bits | (bits << 4))  & 0x0F0F0F0F0F0F0F0Full;
+   bits = (bits | (bits << 2))  & 0x3333333333333333ull;
+   bits = (bits | (bits << 1))  & 0x5555555555555555ull;
+   return bits;
+}
+
+/************************************
+ * QUANTIZE
+ * Map [-extent, extent] onto 32 bits, clamping anything outside
+ ************************************/
+inline uint32_t quantize(double value, double extent)
+{
+   double unit = (value + extent) / (2.0 * extent);
+   unit = std::max(0.0, std::min(1.0, unit));
+   return (uint32_t)(unit * 4294967295.0);
+}
+
+/************************************
+ * MORTON KEY
+ * Z-order of a point inside the square [-extent, extent]^2. The top two
+ * bits pick the quadrant, the next two the quadrant inside that, ...
+ ************************************/
+inline uint64_t mortonKey(double x, double y, double extent)
+{
+   return spreadBits(quantize(x, extent)) | (spreadBits(quantize(y, extent)) << 1);
+}
@@ -0,0 +1,353 @@
+/***********************************************************************
+ * Source File:
+ *    N-Body
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Mutual gravity through a Barnes-Hut quadtree
+ ************************************************************************/
+
+#include "nBody.h"
+#include "mortonOrder.h"
+#include "parallelFor.h"
+#include <algorithm>   // for sort, min, and max
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <utility>     // for pair
+using namespace std;
+
+/************************************
+ * SPLIT QUADRANTS
+ * The keys in [begin, end) share every bit above shift, so the four
+ * quadrants below are four runs one after another. bounds[q] to
+ * bounds[q + 1] is quadrant q.
+ ************************************/
+static void splitQuadrants(const vector <uint64_t>& keys, uint32_t begin, uint32_t end,
+                           int shift, uint32_t bounds[5])
+{
+   bounds[0] = begin;
+   for (int q = 0; q < 4; q++)
+      bounds[q + 1] = (uint32_t)(partition_point(keys.begin() + bounds[q], keys.begin() + end,
+         [shift, q](uint64_t key) { return (int)((key >> shift) & 3) <= q; }) - keys.begin());
+}
+
+/************************************
+ * N BODY :: ADD
+ ************************************/
+void NBody::add(const Position& pos, const Velocity& vel, double mass)
+{
+   x.push_back(pos.getMetersX());
+   y.push_back(pos.getMetersY());
+   dx.push_back(vel.getDX());
+   dy.push_back(vel.getDY());
+   this->mass.push_back(mass);
+   accelerationValid = false;
+}
+
+/************************************
+ * N BODY :: BUILD NODE
+ * One node and everything under it. Returns the node's index.
+ ************************************/
+int NBody::buildNode(vector <Node>& nodes, uint32_t begin, uint32_t end,
+                     int level, double width) const
+{
+   int index = (int)nodes.size();
+   Node node = { 0.0, 0.0, 0.0, width, begin, end, { -1, -1, -1, -1 } };
+   nodes.push_back(node);
+
+   double total = 0.0;
+   double sumX = 0.0;
+   double sumY = 0.0;
+
+   // few enough bodies, or as deep as the keys go
+   if (end - begin <= (uint32_t)leafSize || level >= 32)
+   {
+      for (uint32_t j = begin; j < end; j++)
+      {
+         total += sortedMass[j];
+         sumX += sortedMass[j] * sortedX[j];
+         sumY += sortedMass[j] * sortedY[j];
+      }
+   }
+   else
+   {
+      uint32_t bounds[5];
+      splitQuadrants(keys, begin, end, 62 - 2 * level, bounds);
+      for (int q = 0; q < 4; q++)
+         if (bounds[q] < bounds[q + 1])
+         {
+            int child = buildNode(nodes, bounds[q], bounds[q + 1], level + 1, width / 2.0);
+            nodes[index].child[q] = child;
+            total += nodes[child].mass;
+            sumX += nodes[child].mass * nodes[child].x;
+            sumY += nodes[child].mass * nodes[child].y;
+         }
+   }
+
+   nodes[index].mass = total;
+   nodes[index].x = total > 0.0 ? sumX / total : 0.0;
+   nodes[index].y = total > 0.0 ? sumY / total : 0.0;
+   return index;
+}
+
+/************************************
+ * N BODY :: BUILD
+ * Sort the bodies into Z-order inside a square around all of them. Every
+ * node of the quadtree is then a run of consecutive bodies, so the tree
+ * falls out of the sorted keys without inserting bodies one by one. The
+ * four quadrants under the root are built on their own threads.
+ ************************************/
+void NBody::build()
+{
+   const size_t n = size();
+   assert(n < 0xFFFFFFFFu);
+   size_t numThreads = getThreadCount(n, threads);
+
+   // a square around everything
+   double xMin = *min_element(x.begin(), x.end());
+   double xMax = *max_element(x.begin(), x.end());
+   double yMin = *min_element(y.begin(), y.end());
+   double yMax = *max_element(y.begin(), y.end());
+   double centerX = (xMin + xMax) / 2.0;
+   double centerY = (yMin + yMax) / 2.0;
+   double extent = max(1.0, max(xMax - xMin, yMax - yMin) / 2.0);
+
+   // keys, in parallel
+   vector <pair <uint64_t, uint32_t>> sorted(n);
+   parallelFor(n, threads, [&](size_t, size_t begin, size_t end)
+   {
+      for (size_t i = begin; i < end; i++)
+         sorted[i] = make_pair(mortonKey(x[i] - centerX, y[i] - centerY, extent),
+                               (uint32_t)i);
+   });
+   sort(sorted.begin(), sorted.end());
+
+   keys.resize(n);
+   order.resize(n);
+   sortedX.resize(n);
+   sortedY.resize(n);
+   sortedMass.resize(n);
+   for (size_t k = 0; k < n; k++)
+   {
+      keys[k] = sorted[k].first;
+      order[k] = sorted[k].second;
+      sortedX[k] = x[order[k]];
+      sortedY[k] = y[order[k]];
+      sortedMass[k] = mass[order[k]];
+   }
+
+   nodes.clear();
+   if (n <= (size_t)leafSize || numThreads == 1)
+   {
+      buildNode(nodes, 0, (uint32_t)n, 0, 2.0 * extent);
+      return;
+   }
+
+   // each quadrant into its own list of nodes
+   uint32_t bounds[5];
+   splitQuadrants(keys, 0, (uint32_t)n, 62, bounds);
+   vector <Node> quadrants[4];
+   vector <thread> workers;
+   for (int q = 0; q < 4; q++)
+      if (bounds[q] < bounds[q + 1])
+         workers.push_back(thread([&, q]()
+         {
+            buildNode(quadrants[q], bounds[q], bounds[q + 1], 1, extent);
+         }));
+   for (auto& worker : workers)
+      worker.join();
+
+   // then the root, with the quadrants appended after it
+   Node root = { 0.0, 0.0, 0.0, 2.0 * extent, 0, (uint32_t)n, { -1, -1, -1, -1 } };
+   nodes.push_back(root);
+   double sumX = 0.0;
+   double sumY = 0.0;
+   for (int q = 0; q < 4; q++)
+   {
+      if (quadrants[q].empty())
+         continue;
+
+      int offset = (int)nodes.size();
+      for (Node node : quadrants[q])
+      {
+         for (int c = 0; c < 4; c++)
+            if (node.child[c] >= 0)
+               node.child[c] += offset;
+         nodes.push_back(node);
+      }
+      nodes[0].child[q] = offset;
+      nodes[0].mass += nodes[offset].mass;
+      sumX += nodes[offset].mass * nodes[offset].x;
+      sumY += nodes[offset].mass * nodes[offset].y;
+   }
+   if (nodes[0].mass > 0.0)
+   {
+      nodes[0].x = sumX / nodes[0].mass;
+      nodes[0].y = sumY / nodes[0].mass;
+   }
+}
+
+/************************************
+ * N BODY :: WALK RANGE
+ * Acceleration of the bodies in Z-order positions [begin, end). Bodies
+ * next to each other in the order open mostly the same nodes, so the
+ * tree stays in cache.
+ ************************************/
+void NBody::walkRange(size_t begin, size_t end,
+                      vector <double>& ddx, vector <double>& ddy) const
+{
+   const double theta2 = theta * theta;
+   const double soft2 = softening * softening;
+   int stack[4 * 33];
+
+   for (size_t k = begin; k < end; k++)
+   {
+      const double px = sortedX[k];
+      const double py = sortedY[k];
+      double ax = 0.0;
+      double ay = 0.0;
+
+      int top = 0;
+      stack[top++] = 0;
+      while (top > 0)
+      {
+         const Node& node = nodes[stack[--top]];
+         double rx = node.x - px;
+         double ry = node.y - py;
+         double r2 = rx * rx + ry * ry;
+
+         // far enough away to count as one body, and not holding this one
+         bool inside = node.begin <= k && k < node.end;
+         if (!inside && node.width * node.width < theta2 * r2)
+         {
+            r2 += soft2;
+            double scale = node.mass / (r2 * sqrt(r2));
+            ax += rx * scale;
+            ay += ry * scale;
+         }
+         // a leaf: every body in it
+         else if (node.child[0] < 0 && node.child[1] < 0 &&
+                  node.child[2] < 0 && node.child[3] < 0)
+         {
+            for (uint32_t j = node.begin; j < node.end; j++)
+            {
+               double bx = sortedX[j] - px;
+               double by = sortedY[j] - py;
+               double b2 = bx * bx + by * by + soft2;
+               if (b2 > 0.0)
+               {
+                  double scale = sortedMass[j] / (b2 * sqrt(b2));
+                  ax += bx * scale;
+                  ay += by * scale;
+               }
+            }
+         }
+         // otherwise open it
+         else
+            for (int c = 0; c < 4; c++)
+               if (node.child[c] >= 0)
+                  stack[top++] = node.child[c];
+      }
+
+      ddx[order[k]] = gravitationalConstant * ax;
+      ddy[order[k]] = gravitationalConstant * ay;
+   }
+}
+
+/************************************
+ * N BODY :: ACCELERATE
+ ************************************/
+void NBody::accelerate(vector <double>& ddx, vector <double>& ddy)
+{
+   const size_t n = size();
+   ddx.assign(n, 0.0);
+   ddy.assign(n, 0.0);
+   if (n == 0)
+      return;
+
+   build();
+
+   parallelFor(n, threads, [&](size_t, size_t begin, size_t end)
+   {
+      walkRange(begin, end, ddx, ddy);
+   });
+}
+
+/************************************
+ * N BODY :: ACCELERATE DIRECT
+ * Every pair, one at a time. Slow, but nothing is approximated.
+ ************************************/
+void NBody::accelerateDirect(vector <double>& ddx, vector <double>& ddy) const
+{
+   const size_t n = size();
+   const double soft2 = softening * softening;
+   ddx.assign(n, 0.0);
+   ddy.assign(n, 0.0);
+
+   for (size_t i = 0; i < n; i++)
+   {
+      double ax = 0.0;
+      double ay = 0.0;
+      for (size_t j = 0; j < n; j++)
+      {
+         double rx = x[j] - x[i];
+         double ry = y[j] - y[i];
+         double r2 = rx * rx + ry * ry + soft2;
+         if (j != i && r2 > 0.0)
+         {
+            double scale = mass[j] / (r2 * sqrt(r2));
+            ax += rx * scale;
+            ay += ry * scale;
+         }
+      }
+      ddx[i] = gravitationalConstant * ax;
+      ddy[i] = gravitationalConstant * ay;
+   }
+}
+
+/************************************
+ * N BODY :: STEP
+ * The forces at the end of one step are the forces at the start of the
+ * next, so each step builds the tree once.
+ ************************************/
+void NBody::step(double time)
+{
+   const double half = time / 2.0;
+   const size_t n = size();
+
+   if (!accelerationValid || ddx.size() != n)
+      accelerate(ddx, ddy);
+
+   // kick and drift
+   for (size_t i = 0; i < n; i++)
+   {
+      dx[i] += ddx[i] * half;
+      dy[i] += ddy[i] * half;
+      x[i] += dx[i] * time;
+      y[i] += dy[i] * time;
+   }
+
+   // kick again with the forces at the new position
+   accelerate(ddx, ddy);
+   for (size_t i = 0; i < n; i++)
+   {
+      dx[i] += ddx[i] * half;
+      dy[i] += ddy[i] * half;
+   }
+   accelerationValid = true;
+}
+
+/************************************
+ * N BODY :: PROPAGATE
+ * The state arrays are public and may have been changed since the last
+ * step, so start from fresh forces.
+ ************************************/
+void NBody::propagate(double duration, double timeStep)
+{
+   assert(timeStep > 0.0);
+   accelerationValid = false;
+   int steps = (int)ceil(duration / timeStep);
+   for (int i = 0; i < steps; i++)
+      step(duration / (double)steps);
+}
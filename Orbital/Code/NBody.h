@@ -0,0 +1,116 @@
+/***********************************************************************
+ * Header File:
+ *    N-Body
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Everything pulls on everything else. Instead of one earth at the
+ *    origin, every body has a mass and feels every other body. Forces
+ *    come from a Barnes-Hut quadtree rebuilt each step: far away groups
+ *    of bodies are treated as one point at their center of mass, which
+ *    brings the cost from n^2 down to about n log n.
+ ************************************************************************/
+
+#pragma once
+
+#include "position.h"
+#include "velocity.h"
+#include <cstdint>
+#include <vector>
+
+const double gravitationalConstant = 6.674e-11;   // m^3 / (kg s^2)
+
+/************************************
+ * N BODY
+ * Bodies with mass, one array per component
+ ************************************/
+class NBody
+{
+public:
+   NBody() :
+      theta(0.5),
+      softening(0.0),
+      leafSize(8),
+      threads(0),
+      accelerationValid(false) {}
+
+   // add a body with a mass in kilograms
+   void add(const Position& pos, const Velocity& vel, double mass);
+
+   // getters
+   size_t size() const { return x.size(); }
+   Position getPosition(size_t i) const { return Position(x[i], y[i]); }
+   Velocity getVelocity(size_t i) const { return Velocity(dx[i], dy[i]); }
+   double getMass(size_t i) const { return mass[i]; }
+   double getTheta() const { return theta; }
+
+   // opening angle: a node is used whole when its width over its distance
+   // is less than this. Zero opens every node, 0.5 is the usual choice.
+   void setTheta(double theta) { this->theta = theta; }
+
+   // meters of softening, so close passes do not fling bodies away
+   void setSoftening(double softening) { this->softening = softening; }
+
+   // bodies a node may hold before it is split
+   void setLeafSize(int leafSize) { this->leafSize = leafSize; }
+
+   // number of worker threads. Zero means one per core.
+   void setThreads(int threads) { this->threads = threads; }
+
+   // acceleration of every body from the tree
+   void accelerate(std::vector <double>& ddx, std::vector <double>& ddy);
+
+   // acceleration of every body from every other body, for checking the tree
+   void accelerateDirect(std::vector <double>& ddx, std::vector <double>& ddy) const;
+
+   // advance every body by time seconds (kick-drift-kick)
+   void step(double time);
+
+   // advance every body by duration seconds in steps of timeStep
+   void propagate(double duration, double timeStep);
+
+   // state of every body, meters and meters/second
+   std::vector <double> x;
+   std::vector <double> y;
+   std::vector <double> dx;
+   std::vector <double> dy;
+
+private:
+   // one square of the tree
+   struct Node
+   {
+      double mass;       // total mass inside
+      double x;          // center of mass
+      double y;
+      double width;      // meters across
+      uint32_t begin;    // bodies [begin, end) in Z-order
+      uint32_t end;
+      int32_t child[4];  // -1 for none; all -1 for a leaf
+   };
+
+   void build();
+   int buildNode(std::vector <Node>& nodes, uint32_t begin, uint32_t end,
+                 int level, double width) const;
+   void walkRange(size_t begin, size_t end,
+                  std::vector <double>& ddx, std::vector <double>& ddy) const;
+
+   std::vector <double> mass;
+
+   // the tree, with the bodies copied in Z-order so each node's bodies
+   // sit side by side
+   std::vector <Node> nodes;
+   std::vector <uint64_t> keys;
+   std::vector <uint32_t> order;
+   std::vector <double> sortedX;
+   std::vector <double> sortedY;
+   std::vector <double> sortedMass;
+
+   std::vector <double> ddx;       // acceleration from the last step
+   std::vector <double> ddy;
+
+   double theta;                   // opening angle
+   double softening;               // meters
+   int leafSize;                   // bodies per leaf
+   int threads;                    // worker threads, 0 for one per core
+   bool accelerationValid;         // ddx and ddy match x and y
+};
@@ -0,0 +1,29 @@
+/***********************************************************************
+ * Source File:
+ *    ORBITAL TESTS
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    orbitaltests: the numerical checks that are too slow for the
+ *    simulator to run on every start. It is its own program: build it
+ *    from this file and every source file of the simulator except
+ *    simulator.cpp, which has the game's main. The exit status is zero
+ *    only when every check passes.
+ ************************************************************************/
+
+#include "testNBody.h"
+using namespace std;
+
+/***********************************************************************
+ * MAIN
+ ************************************************************************/
+int main()
+{
+   int failed = 0;
+
+   TestNBody nBody;
+   nBody.run();
+   failed += nBody.report();
+
+   return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+/***********************************************************************
+ * Header File:
+ *    Parallel For
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Split a run of independent items across worker threads. Every
+ *    thread owns one contiguous slice for the whole run, so it can keep
+ *    its own results and nothing is shared while working.
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>   // for min and max
+#include <cstddef>     // for size_t
+#include <thread>
+#include <vector>
+
+/************************************
+ * GET THREAD COUNT
+ * How many slices count items are split into: threads, or one per core
+ * when threads is zero, but never more slices than items
+ ************************************/
+inline size_t getThreadCount(size_t count, int threads)
+{
+   size_t numThreads = threads > 0 ? (size_t)threads :
+                                     std::max(1u, std::thread::hardware_concurrency());
+   return std::max((size_t)1, std::min(numThreads, count));
+}
+
+/************************************
+ * PARALLEL FOR
+ * Call work(slice, begin, end) once for each slice of [0, count).
+ * A single slice runs on the calling thread.
+ ************************************/
+template <class Work>
+void parallelFor(size_t count, int threads, Work work)
+{
+   size_t numThreads = getThreadCount(count, threads);
+   if (numThreads == 1)
+   {
+      work((size_t)0, (size_t)0, count);
+      return;
+   }
+
+   size_t perThread = (count + numThreads - 1) / numThreads;
+   std::vector <std::thread> workers;
+   for (size_t i = 0; i < numThreads; i++)
+   {
+      size_t begin = std::min(count, i * perThread);
+      size_t end = std::min(count, begin + perThread);
+      workers.push_back(std::thread(work, i, begin, end));
+   }
+   for (auto& worker : workers)
+      worker.join();
+}
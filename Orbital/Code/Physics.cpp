@@ -9,8 +9,6 @@
 
 #include "physics.h"  // for the prototypes
 
-const double earthRadius = 6378000.0;
-
 /**********************************************************
  * GET ALTITUDE
  * Return the altitude of a point above the earth's surface
@@ -34,7 +32,6 @@ Acceleration getGravity(const Position& posElement)
    Angle angle;
    angle.setDxDy(-posElement.getMetersX(), -posElement.getMetersY());
    
-   double standardGravity = 9.806;
    double tmp = earthRadius / (earthRadius + height);
    double acceleration = standardGravity * tmp * tmp;
 
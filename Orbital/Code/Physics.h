@@ -18,6 +18,9 @@
 #include <cassert>  // for ASSERT 
 #include <cmath>    // for abs
 
+const double earthRadius = 6378000.0;   // meters
+const double standardGravity = 9.806;   // m/s^2 at the surface
+
 /**********************************************************
 * ACCELERATION GET ALTITUDE
 * Return the altitude of a point above the earth's surface
@@ -0,0 +1,214 @@
+/***********************************************************************
+ * Source File:
+ *    REORDER BENCHMARK
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    reorderbench: cache misses and time of the propagation and
+ *    collision loops before and after the satellites are packed into
+ *    Z-order. It is its own program: build it from this file and every
+ *    source file of the simulator except simulator.cpp, which has the
+ *    game's main.
+ *
+ *    The debris is made the way breakups make it: one fragment at a
+ *    time, with other allocations in between, so neighbors in space are
+ *    strangers in memory. Cache misses come from the hardware counters
+ *    on Linux; where those are not available only the times are shown.
+ *
+ *    usage: reorderbench [fragments] [frames]
+ ************************************************************************/
+
+#include "satellite.h"
+#include "satelliteArena.h"
+#include "forceModel.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>     // for atoi and rand
+#include <list>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>     // for memset
+#endif // __linux__
+using namespace std;
+
+#define BENCH_FRAGMENTS 4000      // objects in orbit
+#define BENCH_FRAMES    10        // frames timed before and after
+#define BENCH_STEP      48.0      // seconds per frame
+#define BENCH_EXTENT    50000000.0   // meters, the same square the simulator sorts in
+
+/***********************************************************************
+ * CACHE MISSES
+ * A hardware counter of last-level cache misses in this thread
+ ************************************************************************/
+class CacheMisses
+{
+public:
+   CacheMisses() : fd(-1)
+   {
+#ifdef __linux__
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof(attr);
+      attr.config = PERF_COUNT_HW_CACHE_MISSES;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif // __linux__
+   }
+   ~CacheMisses()
+   {
+#ifdef __linux__
+      if (fd >= 0)
+         close(fd);
+#endif // __linux__
+   }
+
+   bool isValid() const { return fd >= 0; }
+
+   void start()
+   {
+#ifdef __linux__
+      if (fd >= 0)
+      {
+         ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+         ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+#endif // __linux__
+   }
+
+   long long stop()
+   {
+      long long count = 0;
+#ifdef __linux__
+      if (fd >= 0)
+      {
+         ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+         if (read(fd, &count, sizeof(count)) != sizeof(count))
+            count = 0;
+      }
+#endif // __linux__
+      return count;
+   }
+
+private:
+   int fd;
+};
+
+/***********************************************************************
+ * PHASES
+ * Totals over the timed frames
+ ************************************************************************/
+struct Phases
+{
+   double moveSeconds;
+   double collideSeconds;
+   long long moveMisses;
+   long long collideMisses;
+   long long close;
+};
+
+/***********************************************************************
+ * RUN
+ * The move and collision loops of Simulator::move. Nothing is killed
+ * here, only counted, so both runs see the same objects.
+ ************************************************************************/
+static Phases run(list <Satellite*>& satellites, int frames, CacheMisses& misses)
+{
+   Phases phases = { 0.0, 0.0, 0, 0, 0 };
+   for (int frame = 0; frame < frames; frame++)
+   {
+      auto start = chrono::steady_clock::now();
+      misses.start();
+      for (auto satellite : satellites)
+         satellite->coast <PointMassModel>(BENCH_STEP);
+      phases.moveMisses += misses.stop();
+      auto middle = chrono::steady_clock::now();
+
+      misses.start();
+      for (auto it1 = satellites.begin(); it1 != satellites.end(); ++it1)
+      {
+         auto it2 = it1;
+         for (++it2; it2 != satellites.end(); ++it2)
+            if (!(*it1)->isDead() && !(*it2)->isDead() &&
+                computeDistance((*it1)->getPosition(), (*it2)->getPosition()) <
+                (*it1)->getRadius() + (*it2)->getRadius())
+               phases.close++;
+      }
+      phases.collideMisses += misses.stop();
+      auto end = chrono::steady_clock::now();
+
+      phases.moveSeconds += chrono::duration <double>(middle - start).count();
+      phases.collideSeconds += chrono::duration <double>(end - middle).count();
+   }
+   return phases;
+}
+
+/***********************************************************************
+ * REPORT
+ ************************************************************************/
+static void report(const char* label, const Phases& phases, int frames, bool counted)
+{
+   printf("%-8s move %8.2f ms/frame", label, 1e3 * phases.moveSeconds / frames);
+   if (counted)
+      printf(" %10lld misses", phases.moveMisses / frames);
+   printf("   collide %8.2f ms/frame", 1e3 * phases.collideSeconds / frames);
+   if (counted)
+      printf(" %10lld misses", phases.collideMisses / frames);
+   printf("   %lld close\n", phases.close);
+}
+
+/***********************************************************************
+ * MAIN
+ ************************************************************************/
+int main(int argc, char** argv)
+{
+   int fragments = argc > 1 ? atoi(argv[1]) : BENCH_FRAGMENTS;
+   int frames = argc > 2 ? atoi(argv[2]) : BENCH_FRAMES;
+   if (fragments <= 0 || frames <= 0)
+   {
+      printf("usage: reorderbench [fragments] [frames]\n");
+      return 1;
+   }
+
+   // debris in circular orbits from low earth orbit out past GPS, each
+   // fragment allocated between unrelated blocks of memory
+   const double mu = standardGravity * earthRadius * earthRadius;
+   list <Satellite*> satellites;
+   vector <vector <char>> clutter;
+   Satellite origin;
+   srand(1);
+   for (int i = 0; i < fragments; i++)
+   {
+      double radius = earthRadius + 400000.0 + 26000000.0 * rand() / RAND_MAX;
+      double angle = 2.0 * M_PI * rand() / RAND_MAX;
+      double speed = sqrt(mu / radius);
+      Satellite parent(origin, Position(radius * sin(angle), radius * cos(angle)),
+                       Velocity(speed * cos(angle), -speed * sin(angle)));
+      clutter.push_back(vector <char>(64 + rand() % 512));
+      satellites.push_back(new Fragment(parent, Angle(360.0 * rand() / RAND_MAX)));
+   }
+   clutter.clear();
+
+   CacheMisses misses;
+   if (!misses.isValid())
+      printf("hardware cache counters are not available; times only\n");
+
+   Phases before = run(satellites, frames, misses);
+   report("scattered", before, frames, misses.isValid());
+
+   SatelliteArena::reorder(satellites, BENCH_EXTENT, [](const Relocation&) {});
+   Phases after = run(satellites, frames, misses);
+   report("packed", after, frames, misses.isValid());
+
+   for (auto satellite : satellites)
+      delete satellite;
+   SatelliteArena::release();
+   return 0;
+}
@@ -14,6 +14,19 @@
 #include "hubble.h"
 #include "crewDragon.h"
 #include "gps.h"
+#include "satelliteArena.h"
+
+ForcePreset Satellite::forces = POINT_MASS;
+
+/************************************
+ * SATELLITE :: DELETE
+ * The arena frees its whole block at once
+ ************************************/
+void Satellite::operator delete(void* p)
+{
+   if (!SatelliteArena::owns(p))
+      ::operator delete(p);
+}
 
  /************************************
  * SATELLITE
@@ -79,16 +92,22 @@ Satellite::Satellite(const Satellite& parent, const Position& offset, const Velo
  ************************************/
 void Satellite::move(double time)
 {
-
    // gravity and intertia
-   Acceleration aGravity = getGravity(pos);
-
-   // update velocity and position due to gravity
-   this->velocity.add(aGravity, time / 2.0);
-   this->pos.add(aGravity, velocity, time);
-   this->velocity.add(aGravity, time / 2.0);
-   this->angle.add(angularVelocity);
-   this->age++;
+   switch (forces)
+   {
+   case OBLATE_EARTH:
+      coast <OblateEarthModel>(time);
+      break;
+   case LOW_EARTH:
+      coast <LowEarthModel>(time);
+      break;
+   default:
+      coast <PointMassModel>(time);
+      break;
+   }
+
+   // and whatever else this kind of satellite does
+   update(time);
 }
 
 /************************************
@@ -107,35 +126,31 @@ Projectile::Projectile(const Ship& parent, Velocity bullet)
 }
 
 /************************************
- * Projectile :: MOVE
- * Tracks the movement of the projectile
+ * Projectile :: UPDATE
+ * Projectiles die
  ************************************/
-void Projectile::move(double timeDilation)
+void Projectile::update(double timeDilation)
 {
-   Satellite::move(timeDilation);
    if (this->age > 100)
       this->dead = true;
 }
 
 /************************************
- * Fragments :: MOVE
+ * Fragments :: UPDATE
  * Fragments die
  ************************************/
-void Fragment::move(double timeDilation)
+void Fragment::update(double timeDilation)
 {
-   Satellite::move(timeDilation);
    if (this->age > 100)
       this->dead = true;
 }
 
 /************************************
- * WHOLE :: MOVE
- * Whole satellites move
+ * WHOLE :: UPDATE
+ * Whole satellites go defunct
  ************************************/
-void Whole::move(double timeDilation)
+void Whole::update(double timeDilation)
 {
-   
-   Satellite::move(timeDilation);
    if (random(0, this->chanceDefunct) == 0)
    {
       this->defunct = true;
@@ -16,6 +16,7 @@
 #include "uiInteract.h"
 #include "uiDraw.h"
 #include "physics.h"
+#include "forceModel.h"
 #include "thrust.h"
 #include <list>
 
@@ -64,6 +65,9 @@ public:
 
    virtual ~Satellite() {}
 
+   // a satellite packed into the arena was not given by the heap
+   static void operator delete(void* p);
+
    //
    // Getters
    //
@@ -104,13 +108,39 @@ public:
    // kill the element
    virtual void destroy(std::list <Satellite*>& satellites) {}
 
-   // advance the item by seconds (timeDilation)
-   virtual void move(double time);
+   // advance the item by seconds (timeDilation) under the forces in use
+   void move(double time);
+
+   // gravity and inertia for one step under one force model. Sweeps
+   // over every object pick the model once and call this directly.
+   template <class Model>
+   void coast(double time)
+   {
+      double ddx;
+      double ddy;
+      Model::accelerate(pos.getMetersX(), pos.getMetersY(),
+                        velocity.getDX(), velocity.getDY(), ddx, ddy);
+      Acceleration aGravity(ddx, ddy);
+
+      velocity.add(aGravity, time / 2.0);
+      pos.add(aGravity, velocity, time);
+      velocity.add(aGravity, time / 2.0);
+      angle.add(angularVelocity);
+      age++;
+   }
+
+   // everything else that happens to the item in a step
+   virtual void update(double time) {}
 
    // handle input
    virtual void input(const Interface& ui, std::list <Satellite*>& satellites) {}
 
+   // which forces act on everything in orbit
+   static ForcePreset getForces() { return forces; }
+   static void setForces(ForcePreset forces) { Satellite::forces = forces; }
+
 protected:
+   static ForcePreset forces;
    Velocity velocity;
    Position pos;
    Angle angle;
@@ -134,7 +164,7 @@ class Projectile : public Satellite
 public:
    Projectile(const Ship& parent, Velocity bullet);
 
-   void move(double timeDilation);
+   void update(double timeDilation);
 
    bool getDefunct() const { return true; }
 
@@ -160,7 +190,7 @@ public:
 
    bool getDefunct() const { return true; }
 
-   void move(double timeDilation);
+   void update(double timeDilation);
 
    virtual void draw(ogstream& gout)
    {
@@ -186,7 +216,7 @@ public:
    void setDefunct(bool defunct) { this->defunct = defunct; }
 
    // whole satellites can go defunct at any time
-   void move(double timeDilation);
+   void update(double timeDilation);
 
 protected:
    bool defunct;
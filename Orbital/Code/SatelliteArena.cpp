@@ -0,0 +1,158 @@
+/***********************************************************************
+ * Source File:
+ *    Satellite Arena
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Packing the satellites into one block in Z-order
+ ************************************************************************/
+
+#include "satelliteArena.h"
+#include "mortonOrder.h"
+#include "satellite.h"
+#include "ship.h"
+#include "gps.h"
+#include "hubble.h"
+#include "sputnik.h"
+#include "starlink.h"
+#include "crewDragon.h"
+#include <algorithm>   // for stable_sort
+#include <cstdint>
+#include <new>         // for placement new
+#include <typeindex>
+#include <utility>     // for pair
+#include <vector>
+using namespace std;
+
+char* SatelliteArena::block = nullptr;
+size_t SatelliteArena::used = 0;
+
+/************************************
+ * RELOCATOR
+ * How to copy one kind of satellite into raw memory
+ ************************************/
+struct Relocator
+{
+   size_t size;                                        // bytes, rounded up
+   Satellite* (*copy)(const Satellite& satellite, void* where);
+};
+
+template <class T>
+Satellite* copyInto(const Satellite& satellite, void* where)
+{
+   return ::new (where) T(static_cast <const T&>(satellite));
+}
+
+template <class T>
+pair <const type_index, Relocator> relocator()
+{
+   const size_t align = alignof(max_align_t);
+   Relocator relocator = { (sizeof(T) + align - 1) / align * align, copyInto <T> };
+   return make_pair(type_index(typeid(T)), relocator);
+}
+
+// every kind of satellite that can be in orbit
+static const unordered_map <type_index, Relocator> relocators =
+{
+   relocator <Ship>(),
+   relocator <Projectile>(),
+   relocator <Fragment>(),
+   relocator <GPS>(),
+   relocator <GPSLeft>(),
+   relocator <GPSRight>(),
+   relocator <GPSCenter>(),
+   relocator <Hubble>(),
+   relocator <HubbleLeft>(),
+   relocator <HubbleRight>(),
+   relocator <HubbleComputer>(),
+   relocator <Sputnik>(),
+   relocator <Starlink>(),
+   relocator <StarlinkBody>(),
+   relocator <StarlinkArray>(),
+   relocator <Dragon>(),
+   relocator <DragonLeft>(),
+   relocator <DragonRight>(),
+   relocator <DragonCenter>()
+};
+
+/************************************
+ * SATELLITE ARENA :: REORDER
+ * The copies go into a new block so the old one stays put until every
+ * satellite in it has been copied out and deleted.
+ ************************************/
+void SatelliteArena::reorder(list <Satellite*>& satellites, double extent,
+                             const function <void(const Relocation&)>& remap)
+{
+   vector <pair <uint64_t, Satellite*>> keyed;
+   keyed.reserve(satellites.size());
+   for (auto satellite : satellites)
+   {
+      const Position& pos = satellite->getPosition();
+      keyed.push_back(make_pair(mortonKey(pos.getMetersX(), pos.getMetersY(), extent),
+                                satellite));
+   }
+   stable_sort(keyed.begin(), keyed.end(),
+               [](const pair <uint64_t, Satellite*>& lhs, const pair <uint64_t, Satellite*>& rhs)
+               {
+                  return lhs.first < rhs.first;
+               });
+
+   // how big the new block is
+   size_t size = 0;
+   for (auto& item : keyed)
+   {
+      auto it = relocators.find(type_index(typeid(*item.second)));
+      if (it != relocators.end())
+         size += it->second.size;
+   }
+   char* fresh = size > 0 ? (char*)::operator new(size) : nullptr;
+
+   // copy in Z-order. The list is rebuilt so its nodes are in order too.
+   Relocation moved;
+   vector <Satellite*> originals;
+   size_t offset = 0;
+   satellites.clear();
+   for (auto& item : keyed)
+   {
+      Satellite* satellite = item.second;
+      auto it = relocators.find(type_index(typeid(*satellite)));
+      if (it != relocators.end())
+      {
+         Satellite* copy = it->second.copy(*satellite, fresh + offset);
+         offset += it->second.size;
+         moved[satellite] = copy;
+         originals.push_back(satellite);
+         satellite = copy;
+      }
+      satellites.push_back(satellite);
+   }
+
+   // everyone holding a satellite learns where it went, then the
+   // originals go: heap ones are freed, ones in the old block are not
+   remap(moved);
+   for (auto satellite : originals)
+      delete satellite;
+
+   ::operator delete(block);
+   block = fresh;
+   used = offset;
+}
+
+/************************************
+ * SATELLITE ARENA :: OWNS
+ ************************************/
+bool SatelliteArena::owns(const void* p)
+{
+   const char* address = (const char*)p;
+   return block != nullptr && address >= block && address < block + used;
+}
+
+/************************************
+ * SATELLITE ARENA :: RELEASE
+ ************************************/
+void SatelliteArena::release()
+{
+   ::operator delete(block);
+   block = nullptr;
+   used = 0;
+}
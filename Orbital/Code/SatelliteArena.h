@@ -0,0 +1,53 @@
+/***********************************************************************
+ * Header File:
+ *    Satellite Arena
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    One block of memory holding the satellites in Z-order of where they
+ *    are. Breakups allocate their fragments wherever the heap has room,
+ *    far from anything near them in space. Packing now and then puts
+ *    every satellite back next to its neighbors, so the move and
+ *    collision loops walk memory front to back.
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>        // for size_t
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+class Satellite;
+
+// where each packed satellite went
+typedef std::unordered_map <const Satellite*, Satellite*> Relocation;
+
+/************************************
+ * SATELLITE ARENA
+ * The block the satellites were last packed into
+ ************************************/
+class SatelliteArena
+{
+public:
+   // Sort the satellites by the Z-order of their position inside
+   // [-extent, extent]^2 and copy them into a new block in that order.
+   // remap() is told where everything went while the originals are
+   // still alive; then they are deleted. A kind of satellite the arena
+   // does not know how to copy keeps its place on the heap.
+   static void reorder(std::list <Satellite*>& satellites, double extent,
+                       const std::function <void(const Relocation&)>& remap);
+
+   // is this memory inside the block?
+   static bool owns(const void* p);
+
+   // give the block back once every satellite in it is deleted
+   static void release();
+
+   // bytes of satellites in the block
+   static size_t size() { return used; }
+
+private:
+   static char* block;
+   static size_t used;
+};
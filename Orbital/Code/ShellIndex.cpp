@@ -0,0 +1,177 @@
+/***********************************************************************
+ * Source File:
+ *    Shell Index
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Objects bucketed by altitude shell and inclination band
+ ************************************************************************/
+
+#include "shellIndex.h"
+#include "satellite.h"
+#include <algorithm>   // for min and max
+#include <cmath>
+using namespace std;
+
+/************************************
+ * SHELL INDEX
+ ************************************/
+ShellIndex::ShellIndex(double shellHeight, int shells, int bands) :
+   shellHeight(shellHeight),
+   shells(shells),
+   bands(bands),
+   buckets((size_t)shells * bands),
+   shellCounts(shells, 0)
+{
+   assert(shellHeight > 0.0 && shells > 0 && bands > 0);
+}
+
+/************************************
+ * SHELL INDEX :: GET SHELL
+ * Below the surface counts as the first shell, above the top as the last
+ ************************************/
+int ShellIndex::getShell(double altitude) const
+{
+   return max(0, min(shells - 1, (int)floor(altitude / shellHeight)));
+}
+
+/************************************
+ * SHELL INDEX :: GET BAND
+ ************************************/
+int ShellIndex::getBand(double inclination) const
+{
+   return max(0, min(bands - 1, (int)floor(inclination / M_PI * bands)));
+}
+
+/************************************
+ * SHELL INDEX :: GET BUCKET
+ * Everything orbits in one plane here, so inclination is 0 for objects
+ * going the same way as the earth turns and 180 degrees for the rest.
+ ************************************/
+int ShellIndex::getBucket(const Satellite* satellite) const
+{
+   const Position& pos = satellite->getPosition();
+   const Velocity& vel = satellite->getVelocity();
+   double momentum = pos.getMetersX() * vel.getDY() - pos.getMetersY() * vel.getDX();
+   double inclination = momentum >= 0.0 ? 0.0 : M_PI;
+
+   return getShell(getAltitude(pos)) * bands + getBand(inclination);
+}
+
+/************************************
+ * SHELL INDEX :: UPDATE
+ * Swap-and-pop out of the old bucket, push onto the new one
+ ************************************/
+void ShellIndex::update(const Satellite* satellite)
+{
+   int bucket = getBucket(satellite);
+   auto it = entries.find(satellite);
+
+   if (it != entries.end())
+   {
+      Entry& entry = it->second;
+      if (entry.bucket == bucket)
+         return;
+
+      remove(satellite);
+   }
+
+   buckets[bucket].push_back(satellite);
+   Entry entry = { bucket, (int)buckets[bucket].size() - 1 };
+   entries[satellite] = entry;
+   shellCounts[bucket / bands]++;
+}
+
+/************************************
+ * SHELL INDEX :: REMOVE
+ ************************************/
+void ShellIndex::remove(const Satellite* satellite)
+{
+   auto it = entries.find(satellite);
+   if (it == entries.end())
+      return;
+
+   Entry entry = it->second;
+   vector <const Satellite*>& bucket = buckets[entry.bucket];
+   const Satellite* moved = bucket.back();
+   bucket[entry.slot] = moved;
+   entries[moved].slot = entry.slot;
+   bucket.pop_back();
+
+   shellCounts[entry.bucket / bands]--;
+   entries.erase(satellite);
+}
+
+/************************************
+ * SHELL INDEX :: REMAP
+ * Same buckets and slots, new addresses
+ ************************************/
+void ShellIndex::remap(const Relocation& moved)
+{
+   unordered_map <const Satellite*, Entry> remapped;
+   remapped.reserve(entries.size());
+   for (auto& item : entries)
+   {
+      auto it = moved.find(item.first);
+      const Satellite* satellite = it == moved.end() ? item.first : it->second;
+      buckets[item.second.bucket][item.second.slot] = satellite;
+      remapped[satellite] = item.second;
+   }
+   entries.swap(remapped);
+}
+
+/************************************
+ * SHELL INDEX :: CLEAR
+ ************************************/
+void ShellIndex::clear()
+{
+   for (auto& bucket : buckets)
+      bucket.clear();
+   fill(shellCounts.begin(), shellCounts.end(), 0);
+   entries.clear();
+}
+
+/************************************
+ * SHELL INDEX :: COUNT
+ * Partial shells at either end count as whole shells
+ ************************************/
+int ShellIndex::count(double altitudeLow, double altitudeHigh) const
+{
+   int total = 0;
+   int last = getShell(nextafter(altitudeHigh, altitudeLow));
+   for (int shell = getShell(altitudeLow); shell <= last; shell++)
+      total += shellCounts[shell];
+   return total;
+}
+
+/************************************
+ * SHELL INDEX :: COUNT
+ ************************************/
+int ShellIndex::count(double altitudeLow, double altitudeHigh,
+                      double inclinationLow, double inclinationHigh) const
+{
+   int total = 0;
+   int lastShell = getShell(nextafter(altitudeHigh, altitudeLow));
+   int lastBand = getBand(nextafter(inclinationHigh, inclinationLow));
+   for (int shell = getShell(altitudeLow); shell <= lastShell; shell++)
+      for (int band = getBand(inclinationLow); band <= lastBand; band++)
+         total += (int)buckets[shell * bands + band].size();
+   return total;
+}
+
+/************************************
+ * SHELL INDEX :: COLLECT
+ ************************************/
+void ShellIndex::collect(double altitudeLow, double altitudeHigh,
+                         double inclinationLow, double inclinationHigh,
+                         vector <const Satellite*>& objects) const
+{
+   int lastShell = getShell(nextafter(altitudeHigh, altitudeLow));
+   int lastBand = getBand(nextafter(inclinationHigh, inclinationLow));
+   for (int shell = getShell(altitudeLow); shell <= lastShell; shell++)
+      for (int band = getBand(inclinationLow); band <= lastBand; band++)
+      {
+         const vector <const Satellite*>& bucket = buckets[shell * bands + band];
+         objects.insert(objects.end(), bucket.begin(), bucket.end());
+      }
+}
@@ -0,0 +1,82 @@
+/***********************************************************************
+ * Header File:
+ *    Shell Index
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Who is in which altitude shell right now? Every object lives in one
+ *    bucket keyed by altitude shell and inclination band. Buckets are
+ *    updated as objects move, so counting a shell never scans the sky.
+ ************************************************************************/
+
+#pragma once
+
+#include "satelliteArena.h"
+#include <cstddef>        // for size_t
+#include <unordered_map>
+#include <vector>
+
+class Satellite;
+
+/************************************
+ * SHELL INDEX
+ * Objects bucketed by altitude and inclination
+ ************************************/
+class ShellIndex
+{
+public:
+   ShellIndex(double shellHeight = 100000.0, int shells = 400, int bands = 6);
+
+   // put an object in the right bucket, moving it if it changed shells
+   void update(const Satellite* satellite);
+
+   // forget an object
+   void remove(const Satellite* satellite);
+
+   // forget everything
+   void clear();
+
+   // follow objects the arena moved
+   void remap(const Relocation& moved);
+
+   // how many objects we know about
+   size_t size() const { return entries.size(); }
+
+   // objects per shell, all inclinations
+   const std::vector <int>& getHistogram() const { return shellCounts; }
+
+   // objects with altitude in [altitudeLow, altitudeHigh) meters
+   int count(double altitudeLow, double altitudeHigh) const;
+
+   // same, limited to inclinations in [inclinationLow, inclinationHigh) radians
+   int count(double altitudeLow, double altitudeHigh,
+             double inclinationLow, double inclinationHigh) const;
+
+   // the objects in those shells and bands
+   void collect(double altitudeLow, double altitudeHigh,
+                double inclinationLow, double inclinationHigh,
+                std::vector <const Satellite*>& objects) const;
+
+   // getters
+   double getShellHeight() const { return shellHeight; }
+   int getShellCount() const { return shells; }
+
+private:
+   // where one object is filed
+   struct Entry
+   {
+      int bucket;   // shell * bands + band
+      int slot;     // position inside the bucket
+   };
+
+   int getShell(double altitude) const;
+   int getBand(double inclination) const;
+   int getBucket(const Satellite* satellite) const;
+
+   double shellHeight;    // meters per shell
+   int shells;            // number of shells, the last one holds everything above
+   int bands;             // number of inclination bands over 0 to 180 degrees
+   std::vector <std::vector <const Satellite*>> buckets;
+   std::vector <int> shellCounts;
+   std::unordered_map <const Satellite*, Entry> entries;
+};
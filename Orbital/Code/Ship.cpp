@@ -8,6 +8,7 @@
  ************************************************************************/
 
 #include "ship.h"
+#include <algorithm>   // for min
 
  /**********************************
   * Ship
@@ -25,6 +26,7 @@ Ship::Ship() : Whole(4000)
    dead = false;
    radius = 6.0 * this->pos.getZoom();
    thrust = false;
+   maneuverDelay = 0.0;
 }
 
 /**********************************
@@ -37,10 +39,20 @@ void Ship::input(const Interface& ui, std::list<Satellite*>& satellites)
 
    if (ui.isDown())
    {
+      burn(30.0);
+   }
+   else if (isManeuvering() && maneuverDelay <= 0.0)
+   {
+      // autopilot: point along the planned burn and use the main engine
+      angle.setDxDy(maneuver.getDX(), maneuver.getDY());
+      double deltaV = std::min(30.0, maneuver.getSpeed());
       Velocity vel;
-      vel.set(angle, 30.0);
-      velocity += vel;
-      thrust = true;
+      vel.set(angle, deltaV);
+      burn(deltaV);
+      maneuver.addDX(-vel.getDX());
+      maneuver.addDY(-vel.getDY());
+      if (maneuver.getSpeed() < 0.001)
+         maneuver = Velocity();
    }
    else
    {
@@ -64,6 +76,30 @@ void Ship::input(const Interface& ui, std::list<Satellite*>& satellites)
    }
 }
 
+/**********************************
+* Ship Burn
+* Fire the main engine for one frame
+**********************************/
+void Ship::burn(double deltaV)
+{
+   Velocity vel;
+   vel.set(angle, deltaV);
+   velocity += vel;
+   thrust = true;
+}
+
+/**********************************
+* Ship Set Maneuver
+* Fly a transfer from the intercept planner
+**********************************/
+void Ship::setManeuver(const Transfer& transfer)
+{
+   if (!transfer.valid)
+      return;
+   maneuver = transfer.burn;
+   maneuverDelay = transfer.departure;
+}
+
 /**********************************
 * Ship Destroy
 * Destroy the Ship
@@ -87,7 +123,7 @@ void Ship::move(double timeDilation, const Interface& ui, std::list<Satellite*>&
    if (isDead()) return;
 
    // Calculate gravity's effect on the ship
-   Acceleration aGravity = getGravity(pos);
+   Acceleration aGravity = getAcceleration(forces, pos, velocity);
 
    // Update velocity due to gravity
    updateVelocity(velocity, aGravity, timeDilation); // Gravity influences velocity
@@ -105,3 +141,13 @@ void Ship::move(double timeDilation, const Interface& ui, std::list<Satellite*>&
    // Handle rotation based on input (clockwise or counterclockwise)
    angle.rotate(angularVelocity * timeDilation); // Apply angular velocity to rotation
 }
+
+/**********************************
+* Ship Update
+* Go defunct like any other satellite and count down to the next maneuver
+**********************************/
+void Ship::update(double timeDilation)
+{
+   Whole::update(timeDilation);
+   maneuverDelay -= timeDilation;
+}
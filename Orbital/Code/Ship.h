@@ -10,6 +10,7 @@
 #pragma once
 
 #include "satellite.h"
+#include "lambert.h"
 
  /**************************************************
   * Ship
@@ -38,6 +39,21 @@ public:
 
    void move(double timeDilation, const Interface& ui, std::list<Satellite*>& satellites);
 
+   // move like any other satellite
+   using Whole::move;
+
+   // count down to a planned maneuver
+   void update(double timeDilation);
+
+   // fly a planned transfer with the same engine the keyboard uses
+   void setManeuver(const Transfer& transfer);
+   bool isManeuvering() const { return maneuver.getSpeed() > 0.0; }
+
 private:
+   // fire the main engine along the current angle
+   void burn(double deltaV);
+
    bool thrust;
+   Velocity maneuver;       // planned burn that is still left to do
+   double maneuverDelay;    // seconds until the planned burn starts
 };
@@ -8,21 +8,15 @@
  ************************************************************************/
 
 #include "simulator.h"     // for SIMULATOR
+#include <chrono>          // for STEADY_CLOCK
 
  /***********************************************************************
   * CONSTRUCTOR
   * Initializes all the member variables of the orbital
   * simulator: Stars, Satellites, ptUpperRight
   ************************************************************************/
-Simulator::Simulator(Position ptUpperRight)
+Simulator::Simulator(Position ptUpperRight) : frame(0), reorderInterval(0), angleEarth(0.0)
 {
-   double frameRate = 30.0;
-   double hoursPerDay = 24.0;
-   double minutesPerHour = 60.0;
-   double secondsPerMinute = 60.0;
-   double secondsPerDay = hoursPerDay * minutesPerHour * secondsPerMinute;
-   double timeDilation = hoursPerDay * minutesPerHour;
-
    // initialize the stars
    for (int i = 0; i < 200; i++)
    {
@@ -32,11 +26,6 @@ Simulator::Simulator(Position ptUpperRight)
    // ship is in the upper right corner
    satellites.push_back(new Ship);
 
-   // rotate the earth
-   double radiansInADay = -3.14159 * 2.0;
-   double radiansPerFrame = (radiansInADay / frameRate) * (timeDilation / secondsPerDay);
-   angleEarth += radiansPerFrame;
-
    // satellites
    for (int i = 0; i < 6; i++)
       satellites.push_back(new GPS(i));
@@ -57,6 +46,7 @@ Simulator::~Simulator()
       it != satellites.end();
       ++it)
       delete * it;
+   SatelliteArena::release();
 }
 
 /*************************************************************************
@@ -77,20 +67,49 @@ void Simulator::input(const Interface& pUI)
  *************************************************************************/
 void Simulator::move()
 {
-   double frameRate = 30.0;
-   double hoursPerDay = 24.0;
-   double minutesPerHour = 60.0;
-   double secondsPerMinute = 60.0;
-   double secondsPerDay = hoursPerDay * minutesPerHour * secondsPerMinute;
-   double timeDilation = hoursPerDay * minutesPerHour;
-   double timeStep = timeDilation / frameRate;
+   double secondsPerDay = 24.0 * 60.0 * 60.0;
+   double radiansInADay = -3.14159 * 2.0;
 
    list <Satellite*> ::iterator it1;
    list <Satellite*> ::iterator it2;
 
-   // advance everything
-   for (auto satellite : satellites)
-      satellite->move(timeStep);
+   // every second or so, see how much error the current step makes
+   WarpPlan plan = governor.plan(satellites.size());
+   if (frame++ % (int)governor.getFrameRate() == 0)
+   {
+      Catalog sample;
+      sample.setForces(Satellite::getForces());
+      for (auto satellite : satellites)
+         if (sample.size() < 64)
+            sample.add(satellite->getPosition(), satellite->getVelocity(), satellite);
+      governor.estimateError(sample, plan.stepSize);
+      plan = governor.plan(satellites.size());
+   }
+
+   // the uncertainty of tracked objects moves from where they are now
+   if (covariances.size() > 0)
+      covariances.propagate(plan.substeps * plan.stepSize, plan.stepSize);
+
+   // advance everything, timing how long it takes. The last substep also
+   // files everything in its altitude shell.
+   auto start = chrono::steady_clock::now();
+   switch (Satellite::getForces())
+   {
+   case OBLATE_EARTH:
+      advance <OblateEarthModel>(plan);
+      break;
+   case LOW_EARTH:
+      advance <LowEarthModel>(plan);
+      break;
+   default:
+      advance <PointMassModel>(plan);
+      break;
+   }
+   chrono::duration <double> elapsed = chrono::steady_clock::now() - start;
+   governor.measure(elapsed.count(), plan.substeps, satellites.size());
+
+   // rotate the earth
+   angleEarth += radiansInADay * (plan.substeps * plan.stepSize) / secondsPerDay;
 
    // look for collisions
    for (it1 = satellites.begin(); it1 != satellites.end(); ++it1)
@@ -117,11 +136,58 @@ void Simulator::move()
    for (it1 = satellites.begin(); it1 != satellites.end();)
       if ((*it1)->isDead())
       {
+         shells.remove(*it1);
+         covariances.forget(*it1);
          (*it1)->destroy(satellites);
          it1 = satellites.erase(it1);
       }
       else
          ++it1;
+
+   // breakups leave fragments wherever the heap had room; put them back
+   // with their neighbors now and then
+   if (reorderInterval > 0 && frame % reorderInterval == 0)
+      reorder();
+}
+
+/*************************************************************************
+ * REORDER
+ * Copy the satellites into one block in the Z-order of their position.
+ * Everything that holds a satellite is told where it went before the
+ * old copies are deleted.
+ *************************************************************************/
+void Simulator::reorder()
+{
+   const double extent = 50000000.0;   // meters, past geosynchronous orbit
+
+   SatelliteArena::reorder(satellites, extent, [this](const Relocation& moved)
+   {
+      shells.remap(moved);
+      covariances.remap(moved);
+   });
+}
+
+/*************************************************************************
+ * ADVANCE
+ * Every substep of a frame under one force model. The model is picked
+ * once per frame, so the loop over the satellites has no switch in it
+ * and Model::accelerate is inlined into it.
+ *************************************************************************/
+template <class Model>
+void Simulator::advance(const WarpPlan& plan)
+{
+   for (int substep = 0; substep < plan.substeps - 1; substep++)
+      for (auto satellite : satellites)
+      {
+         satellite->coast <Model>(plan.stepSize);
+         satellite->update(plan.stepSize);
+      }
+   for (auto satellite : satellites)
+   {
+      satellite->coast <Model>(plan.stepSize);
+      satellite->update(plan.stepSize);
+      shells.update(satellite);
+   }
 }
 
 /*************************************************************************
@@ -142,6 +208,27 @@ void Simulator::draw(ogstream& gout)
 
    // then the earth
    gout.drawEarth(ptEarth, angleEarth);
+
+   // how crowded each orbit is, straight from the shell index
+   Position ptCounts;
+   ptCounts.setPixelsX(-480.0);
+   ptCounts.setPixelsY(480.0);
+   gout = ptCounts;
+   gout << "LEO: " << shells.count(0.0, 2000000.0) << endl;
+   gout << "MEO: " << shells.count(2000000.0, 35000000.0) << endl;
+   gout << "GEO: " << shells.count(35000000.0, 37000000.0) << endl;
+
+   // let the user know if we cannot keep up
+   const WarpPlan& plan = governor.getPlan();
+   if (!plan.targetMet)
+   {
+      Position ptMessage;
+      ptMessage.setPixelsX(-480.0);
+      ptMessage.setPixelsY(-480.0);
+      gout = ptMessage;
+      gout << "Time warp " << (int)plan.achievedRate << "x of "
+           << (int)governor.getTarget() << "x" << endl;
+   }
 }
 
 /*************************************************************************
@@ -22,6 +22,10 @@
 #include "hubble.h"     // for HUBBLE
 #include "Test.h"       // for test
 #include "physics.h"    // for physics calculations
+#include "timeWarp.h"   // for TIME WARP GOVERNOR
+#include "shellIndex.h" // for SHELL INDEX
+#include "covariance.h" // for COVARIANCE TRACKER
+#include "satelliteArena.h" // for SATELLITE ARENA
 #include <list>         // for LIST
 
 using namespace std;
@@ -42,12 +46,42 @@ public:
    void move();
    void draw(ogstream& gout);
 
+   // which forces act on everything in orbit
+   void setForces(ForcePreset forces) { Satellite::setForces(forces); }
+
+   // pack the satellites into Z-order every so many frames, 0 for never
+   void setReorderInterval(int frames) { reorderInterval = frames; }
+
+   // who is in which altitude shell right now
+   const ShellIndex& getShells() const { return shells; }
+
+   // how sure we are where tracked objects are
+   CovarianceTracker& getCovariances() { return covariances; }
+
+   // simulated seconds per wall second and wall seconds per frame to spend
+   void setTimeWarp(double targetRate, double frameBudget)
+   {
+      governor.setTarget(targetRate);
+      governor.setFrameBudget(frameBudget);
+   }
+
 private:
+   // move everything through one frame under one force model
+   template <class Model>
+   void advance(const WarpPlan& plan);
+
+   // pack the satellites by where they are
+   void reorder();
+
    list<Satellite*> satellites;    // collection of satellites in orbit
    Star stars[200];
    Position ptUpperRight;
    Position ptEarth;
-   double timeDilation;
+   TimeWarpGovernor governor;      // how far to move each frame
+   ShellIndex shells;              // satellites by altitude and inclination
+   CovarianceTracker covariances;  // uncertainty of tracked satellites
+   int frame;                      // frames since the start
+   int reorderInterval;            // frames between Z-order packs
    double angleEarth;
    Thrust thrust;
    Projectile* proj;
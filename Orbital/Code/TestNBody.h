@@ -0,0 +1,115 @@
+/***********************************************************************
+ * Header File:
+ *    Test N-Body
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The Barnes-Hut tree against direct summation over every pair
+ ************************************************************************/
+
+#pragma once
+
+#include "testSuite.h"
+#include "nBody.h"
+#include "physics.h"
+#include <algorithm>   // for max
+#include <random>
+#include <vector>
+
+/************************************
+ * TEST N BODY
+ ************************************/
+class TestNBody : public TestSuite
+{
+public:
+   TestNBody() : TestSuite("NBody") {}
+
+   void run()
+   {
+      openEveryNode();
+      openingAngleHalf();
+      openingAngleWide();
+      sameOnAnyThreads();
+      twoBodyOrbit();
+   }
+
+private:
+   // a cluster of bodies like the ones the mode is for
+   static void cluster(NBody& bodies, int count)
+   {
+      std::mt19937 random(2);
+      std::normal_distribution <double> spread(0.0, 1.0e7);
+      for (int i = 0; i < count; i++)
+         bodies.add(Position(spread(random), spread(random)), Velocity(), 1.0e20 * (1 + i % 3));
+      bodies.setSoftening(1.0e4);
+   }
+
+   // mean of |tree - direct| / |direct| over every body
+   static double meanError(NBody& bodies)
+   {
+      std::vector <double> ddx, ddy, directX, directY;
+      bodies.accelerate(ddx, ddy);
+      bodies.accelerateDirect(directX, directY);
+      double sum = 0.0;
+      for (size_t i = 0; i < bodies.size(); i++)
+         sum += hypot(ddx[i] - directX[i], ddy[i] - directY[i]) / hypot(directX[i], directY[i]);
+      return sum / bodies.size();
+   }
+
+   // theta of zero never uses a node whole, so only the order of the
+   // sums differs from direct summation
+   void openEveryNode()
+   {
+      NBody bodies;
+      cluster(bodies, 2000);
+      bodies.setTheta(0.0);
+      checkClose(meanError(bodies), 0.0, 1e-12, "theta 0 matches direct summation");
+   }
+
+   // the usual opening angle: within 2 percent on average
+   void openingAngleHalf()
+   {
+      NBody bodies;
+      cluster(bodies, 2000);
+      bodies.setTheta(0.5);
+      checkClose(meanError(bodies), 0.0, 0.02, "theta 0.5 within 2% of direct summation");
+   }
+
+   // a wide angle trades accuracy for speed: within 5 percent
+   void openingAngleWide()
+   {
+      NBody bodies;
+      cluster(bodies, 2000);
+      bodies.setTheta(0.8);
+      checkClose(meanError(bodies), 0.0, 0.05, "theta 0.8 within 5% of direct summation");
+   }
+
+   // splitting the walk across threads changes nothing
+   void sameOnAnyThreads()
+   {
+      NBody bodies;
+      cluster(bodies, 2000);
+      std::vector <double> oneX, oneY, manyX, manyY;
+      bodies.setThreads(1);
+      bodies.accelerate(oneX, oneY);
+      bodies.setThreads(4);
+      bodies.accelerate(manyX, manyY);
+      check(oneX == manyX && oneY == manyY, "one thread and four threads agree");
+   }
+
+   // a small body around the earth comes back around after one period
+   void twoBodyOrbit()
+   {
+      const double mu = standardGravity * earthRadius * earthRadius;
+      const double radius = earthRadius + 500000.0;
+      NBody bodies;
+      bodies.add(Position(0.0, 0.0), Velocity(0.0, 0.0), mu / gravitationalConstant);
+      bodies.add(Position(0.0, radius), Velocity(-sqrt(mu / radius), 0.0), 1000.0);
+      bodies.propagate(2.0 * M_PI * sqrt(radius * radius * radius / mu), 1.0);
+
+      double x = bodies.x[1] - bodies.x[0];
+      double y = bodies.y[1] - bodies.y[0];
+      checkClose(hypot(x, y), radius, 100.0, "orbit radius after one period");
+      checkClose(x, 0.0, 1000.0, "back where it started after one period");
+   }
+};
@@ -0,0 +1,95 @@
+/***********************************************************************
+ * Source File:
+ *    Time Warp
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Decide how far to move the simulation each frame
+ ************************************************************************/
+
+#include "timeWarp.h"
+#include <algorithm>   // for min and max
+#include <cmath>
+using namespace std;
+
+/************************************
+ * TIME WARP GOVERNOR :: PLAN
+ * Accuracy decides the fewest steps we need; cost decides the most we
+ * can afford. If they cross, keep the accuracy and run slower.
+ ************************************/
+WarpPlan TimeWarpGovernor::plan(size_t objects)
+{
+   double perFrame = targetRate / frameRate;
+   int needed = max(1, (int)ceil(perFrame / maxStepSize - 1.0e-9));
+
+   int affordable = needed;
+   double perStep = costPerObjectStep * (double)max((size_t)1, objects);
+   if (perStep > 0.0)
+      affordable = max(1, (int)floor(frameBudget / perStep));
+
+   WarpPlan plan;
+   if (needed <= affordable)
+   {
+      plan.substeps = needed;
+      plan.stepSize = perFrame / (double)needed;
+      plan.targetMet = true;
+   }
+   else
+   {
+      plan.substeps = affordable;
+      plan.stepSize = min(maxStepSize, perFrame / (double)affordable);
+      plan.targetMet = false;
+   }
+   plan.achievedRate = plan.substeps * plan.stepSize * frameRate;
+   last = plan;
+   return plan;
+}
+
+/************************************
+ * TIME WARP GOVERNOR :: MEASURE
+ * A running average so one slow frame does not whip the plan around
+ ************************************/
+void TimeWarpGovernor::measure(double seconds, int substeps, size_t objects)
+{
+   if (substeps <= 0 || objects == 0)
+      return;
+
+   double cost = seconds / ((double)substeps * (double)objects);
+   if (costPerObjectStep == 0.0)
+      costPerObjectStep = cost;
+   else
+      costPerObjectStep = 0.9 * costPerObjectStep + 0.1 * cost;
+}
+
+/************************************
+ * TIME WARP GOVERNOR :: ESTIMATE ERROR
+ * Step doubling. Kick-drift-kick makes an error of order h^3 per step,
+ * so the error of the full step scales the step to fit the tolerance.
+ ************************************/
+void TimeWarpGovernor::estimateError(const Catalog& sample, double stepSize)
+{
+   if (sample.empty() || stepSize <= 0.0)
+      return;
+
+   Catalog whole = sample;
+   Catalog halves = sample;
+   whole.step(stepSize);
+   halves.step(stepSize / 2.0);
+   halves.step(stepSize / 2.0);
+
+   double error = 0.0;
+   for (size_t i = 0; i < sample.size(); i++)
+   {
+      double ex = whole.x[i] - halves.x[i];
+      double ey = whole.y[i] - halves.y[i];
+      error = max(error, sqrt(ex * ex + ey * ey));
+   }
+
+   // the two half steps are about four times better, so this is the error
+   // of the full step to within a third
+   error *= 4.0 / 3.0;
+   if (error <= 0.0)
+      maxStepSize = max(maxStepSize, stepSize * 2.0);
+   else
+      maxStepSize = stepSize * min(2.0, 0.9 * cbrt(tolerance / error));
+}
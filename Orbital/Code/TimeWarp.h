@@ -0,0 +1,79 @@
+/***********************************************************************
+ * Header File:
+ *    Time Warp
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    Decide how far to move the simulation each frame. Given how fast
+ *    simulated time should run and how much of a frame we may spend, the
+ *    governor picks the number of steps and the step size from what a
+ *    step actually costs on this machine and how much error it makes.
+ ************************************************************************/
+
+#pragma once
+
+#include "catalog.h"
+
+/************************************
+ * WARP PLAN
+ * What to do this frame
+ ************************************/
+struct WarpPlan
+{
+   int substeps;          // how many times to move everything
+   double stepSize;       // simulated seconds per substep
+   double achievedRate;   // simulated seconds per wall second we will get
+   bool targetMet;        // false if we had to slow down
+};
+
+/************************************
+ * TIME WARP GOVERNOR
+ * Pick the substeps for each frame
+ ************************************/
+class TimeWarpGovernor
+{
+public:
+   TimeWarpGovernor(double targetRate = 24.0 * 60.0, double frameRate = 30.0) :
+      targetRate(targetRate),
+      frameRate(frameRate),
+      frameBudget(0.5 / frameRate),
+      tolerance(100.0),
+      maxStepSize(targetRate / frameRate),
+      costPerObjectStep(0.0),
+      last() {}
+
+   // simulated seconds per wall second
+   void setTarget(double targetRate) { this->targetRate = targetRate; }
+   double getTarget() const { return targetRate; }
+
+   // wall seconds per frame we may spend moving satellites
+   void setFrameBudget(double frameBudget) { this->frameBudget = frameBudget; }
+
+   // meters of position error allowed in one step
+   void setTolerance(double tolerance) { this->tolerance = tolerance; }
+
+   // frames per wall second
+   double getFrameRate() const { return frameRate; }
+
+   // the plan for a frame moving this many objects
+   WarpPlan plan(size_t objects);
+
+   // the last plan handed out
+   const WarpPlan& getPlan() const { return last; }
+
+   // how long the last frame's substeps really took
+   void measure(double seconds, int substeps, size_t objects);
+
+   // compare one step with two half steps on a sample of objects and
+   // work out the largest step that stays inside the tolerance
+   void estimateError(const Catalog& sample, double stepSize);
+
+private:
+   double targetRate;          // simulated seconds per wall second
+   double frameRate;           // frames per wall second
+   double frameBudget;         // wall seconds per frame for moving
+   double tolerance;           // meters per step
+   double maxStepSize;         // largest step inside the tolerance
+   double costPerObjectStep;   // wall seconds to move one object one step
+   WarpPlan last;
+};
@@ -0,0 +1,81 @@
+/***********************************************************************
+ * Source File:
+ *    Trajectory
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The path of one object sampled at a fixed step
+ ************************************************************************/
+
+#include "trajectory.h"
+#include <cmath>
+using namespace std;
+
+/************************************
+ * TRAJECTORY :: RECORD
+ * Add one sample from a catalog row
+ ************************************/
+void Trajectory::record(const Catalog& catalog, size_t row)
+{
+   x.push_back(catalog.x[row]);
+   y.push_back(catalog.y[row]);
+   dx.push_back(catalog.dx[row]);
+   dy.push_back(catalog.dy[row]);
+}
+
+/************************************
+ * TRAJECTORY :: GET STATE
+ * Cubic Hermite between the two nearest samples. Velocity is the
+ * derivative of the same curve so the two always agree.
+ ************************************/
+void Trajectory::getState(double t, double& px, double& py, double& vx, double& vy) const
+{
+   assert(!x.empty());
+   size_t last = x.size() - 1;
+   double index = t / timeStep;
+   if (last == 0 || index <= 0.0)
+      index = 0.0;
+   if (index >= (double)last)
+      index = (double)last;
+
+   size_t i = min((size_t)index, last == 0 ? 0 : last - 1);
+   size_t j = min(i + 1, last);
+   double u = index - (double)i;
+   double h = timeStep;
+
+   double u2 = u * u;
+   double u3 = u2 * u;
+   double h00 = 2.0 * u3 - 3.0 * u2 + 1.0;
+   double h10 = u3 - 2.0 * u2 + u;
+   double h01 = -2.0 * u3 + 3.0 * u2;
+   double h11 = u3 - u2;
+   px = h00 * x[i] + h10 * h * dx[i] + h01 * x[j] + h11 * h * dx[j];
+   py = h00 * y[i] + h10 * h * dy[i] + h01 * y[j] + h11 * h * dy[j];
+
+   // d/dt of the basis functions
+   double d00 = (6.0 * u2 - 6.0 * u) / h;
+   double d10 = 3.0 * u2 - 4.0 * u + 1.0;
+   double d01 = (-6.0 * u2 + 6.0 * u) / h;
+   double d11 = 3.0 * u2 - 2.0 * u;
+   vx = d00 * x[i] + d10 * dx[i] + d01 * x[j] + d11 * dx[j];
+   vy = d00 * y[i] + d10 * dy[i] + d01 * y[j] + d11 * dy[j];
+}
+
+/************************************
+ * RECORD TRAJECTORIES
+ * Step a catalog and keep every row's path
+ ************************************/
+vector <Trajectory> recordTrajectories(Catalog catalog, double duration, double timeStep)
+{
+   vector <Trajectory> trajectories(catalog.size(), Trajectory(timeStep));
+   int steps = max(1, (int)ceil(duration / timeStep));
+
+   for (int k = 0; k <= steps; k++)
+   {
+      if (k > 0)
+         catalog.step(timeStep);
+      for (size_t row = 0; row < catalog.size(); row++)
+         trajectories[row].record(catalog, row);
+   }
+   return trajectories;
+}
@@ -0,0 +1,50 @@
+/***********************************************************************
+ * Header File:
+ *    Trajectory
+ * Author:
+ *    Matt Benson
+ * Summary:
+ *    The path of one object sampled at a fixed step. In between samples
+ *    the position follows a cubic Hermite curve through both ends.
+ ************************************************************************/
+
+#pragma once
+
+#include "catalog.h"
+#include <vector>
+
+/************************************
+ * TRAJECTORY
+ * Samples of one object, every timeStep seconds starting at zero
+ ************************************/
+class Trajectory
+{
+public:
+   Trajectory(double timeStep = 10.0) : timeStep(timeStep) {}
+
+   // record the state of one catalog row as the next sample
+   void record(const Catalog& catalog, size_t row);
+
+   // getters
+   double getTimeStep() const { return timeStep; }
+   double getDuration() const { return x.size() < 2 ? 0.0 : timeStep * (double)(x.size() - 1); }
+   size_t size() const { return x.size(); }
+
+   // interpolated state at time t, clamped to the recorded span
+   void getState(double t, double& px, double& py, double& vx, double& vy) const;
+
+   // sample values
+   std::vector <double> x;
+   std::vector <double> y;
+   std::vector <double> dx;
+   std::vector <double> dy;
+
+private:
+   double timeStep;
+};
+
+/************************************
+ * RECORD TRAJECTORIES
+ * Step a catalog for duration seconds and record every row
+ ************************************/
+std::vector <Trajectory> recordTrajectories(Catalog catalog, double duration, double timeStep);